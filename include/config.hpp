@@ -1,6 +1,44 @@
 #pragma once
 #include <string>
+#include <cstddef>
 
 // Путь к файлу базы данных (относительно рабочей директории)
 // Директория создается автоматически при первом запуске
 const std::string DB_FILE_PATH = "./data/database.wdb";
+
+// Бинарный файл с атрибутами связей (тип, вес, время) рядом с базой данных
+const std::string EDGE_FILE_PATH = "./data/edges.wdbe";
+
+// Максимальное число закэшированных результатов запросов (/api/nodes, /api/nodes/count)
+// и их примерный суммарный объём в байтах; результат больше четверти объёма не кэшируется
+const size_t QUERY_CACHE_CAPACITY = 256;
+const size_t QUERY_CACHE_MAX_BYTES = 64 << 20;
+
+// Параллельное сканирование: число потоков (0 = все ядра, переопределяется WHISPERDB_SCAN_THREADS),
+// порог числа просматриваемых узлов и размер порции (morsel), выдаваемой потоку за раз
+const size_t SCAN_THREADS = 0;
+const size_t PARALLEL_SCAN_THRESHOLD = 16384;
+const size_t SCAN_MORSEL_SIZE = 2048;
+
+// Сколько существующих тегов банка передавать в промпт DeepSeek: отбираются наиболее
+// близкие к тексту документа (совпадение слов, совместная встречаемость, популярность)
+const size_t PROMPT_TAG_LIMIT = 64;
+
+// Обход графа (/api/nodes/:id/neighborhood, /api/path): верхние границы числа узлов
+// в окрестности и числа посещённых узлов при поиске пути — ограничивают время ответа
+const size_t NEIGHBORHOOD_MAX_NODES = 5000;
+const size_t PATH_MAX_VISITED = 200000;
+
+// Проверка согласованности связей (взаимность, ссылки на удалённые узлы) в фоне:
+// запускается после загрузки и каждые LINK_CHECK_INTERVAL изменений связей
+const size_t LINK_CHECK_INTERVAL = 1000;
+
+// Раскладка графа для веб-клиента (/api/graph/layout): число итераций при расчёте с нуля
+// и при уточнении после изменения связей (старые узлы стартуют с прежних позиций)
+const size_t LAYOUT_ITERATIONS = 100;
+const size_t LAYOUT_REFINE_ITERATIONS = 30;
+
+// Повтор упавших фоновых расчётов (PageRank, раскладка): пауза после первой ошибки,
+// удваивается с каждой следующей до верхней границы
+const size_t JOB_RETRY_MIN_MS = 1000;
+const size_t JOB_RETRY_MAX_MS = 60000;
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Compressed bitmap over 32-bit ids (Roaring layout).
+// Ids are split into a 16-bit container key and a 16-bit low part. Sparse
+// containers keep a sorted uint16 array, dense ones (> 4096 values) switch to a
+// 65536-bit bitset so AND/OR/count run as word loops with popcount.
+class RoaringBitmap
+{
+public:
+    RoaringBitmap() = default;
+
+    void add(uint32_t value);
+    void remove(uint32_t value);
+    bool contains(uint32_t value) const;
+    void clear() { containers_.clear(); }
+
+    uint64_t cardinality() const;
+    bool empty() const { return containers_.empty(); }
+
+    // Set operations
+    RoaringBitmap operator&(const RoaringBitmap& other) const;
+    RoaringBitmap operator|(const RoaringBitmap& other) const;
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+    RoaringBitmap& operator|=(const RoaringBitmap& other);
+
+    // Size of the intersection without materializing it
+    uint64_t andCardinality(const RoaringBitmap& other) const;
+
+    // Visit set values in ascending order; stop early when f returns false
+    template <typename F>
+    void forEach(F&& f) const;
+
+    // Same, in descending order
+    template <typename F>
+    void forEachReverse(F&& f) const;
+
+    std::vector<uint32_t> toVector() const;
+
+private:
+    static constexpr uint32_t ARRAY_MAX = 4096;  // Array -> bitset conversion point
+    static constexpr uint32_t BITSET_WORDS = 1024; // 65536 bits
+
+    struct Container {
+        uint16_t key = 0;
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> array; // Sorted values (sparse form)
+        std::vector<uint64_t> bits;  // BITSET_WORDS words (dense form)
+
+        bool isBitset() const { return !bits.empty(); }
+        void toBitset();
+        void toArray();
+    };
+
+    std::vector<Container> containers_; // Sorted by key
+
+    Container* findContainer(uint16_t key);
+    const Container* findContainer(uint16_t key) const;
+
+    static Container andContainers(const Container& a, const Container& b);
+    static Container orContainers(const Container& a, const Container& b);
+    static uint32_t andCardinality(const Container& a, const Container& b);
+};
+
+template <typename F>
+void RoaringBitmap::forEach(F&& f) const
+{
+    for (const auto& c : containers_) {
+        uint32_t high = static_cast<uint32_t>(c.key) << 16;
+        if (c.isBitset()) {
+            for (uint32_t w = 0; w < BITSET_WORDS; ++w) {
+                uint64_t word = c.bits[w];
+                while (word) {
+                    uint32_t bit = static_cast<uint32_t>(__builtin_ctzll(word));
+                    if (!f(high | (w * 64 + bit))) return;
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (uint16_t low : c.array) {
+                if (!f(high | low)) return;
+            }
+        }
+    }
+}
+
+template <typename F>
+void RoaringBitmap::forEachReverse(F&& f) const
+{
+    for (auto c = containers_.rbegin(); c != containers_.rend(); ++c) {
+        uint32_t high = static_cast<uint32_t>(c->key) << 16;
+        if (c->isBitset()) {
+            for (uint32_t w = BITSET_WORDS; w-- > 0;) {
+                uint64_t word = c->bits[w];
+                while (word) {
+                    uint32_t bit = 63u - static_cast<uint32_t>(__builtin_clzll(word));
+                    if (!f(high | (w * 64 + bit))) return;
+                    word &= ~(1ULL << bit);
+                }
+            }
+        } else {
+            for (auto v = c->array.rbegin(); v != c->array.rend(); ++v) {
+                if (!f(high | *v)) return;
+            }
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "core/CsrGraph.hpp"
+
+// Parallel connected components on the shared thread pool.
+// A lock-free union-find where roots are hooked under the smaller root with
+// compare-and-swap, so every component ends up labelled with its smallest
+// vertex. The CSR variant follows Afforest: link a couple of neighbors per
+// vertex, find the dominant component from a sample, and only scan the
+// remaining edges of vertices outside it.
+class ConnectedComponents
+{
+public:
+    // Undirected edges over vertices [0, vertexCount)
+    static std::vector<uint32_t> fromEdges(size_t vertexCount, const std::vector<std::pair<uint32_t, uint32_t>>& edges);
+
+    // Symmetric CSR graph (both directions stored)
+    static std::vector<uint32_t> fromGraph(const CsrGraph& graph);
+};
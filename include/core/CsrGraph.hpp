@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "core/EdgeStore.hpp"
+
+// Undirected link graph in compressed sparse row form over dense indices.
+// Vertex i is the i-th smallest node id; the neighbors of i are
+// targets[offsets[i] .. offsets[i + 1]), sorted and unique. Traversals
+// index flat arrays instead of hashing node ids or copying nodes. Edge
+// weights and types, when given, sit in columns parallel to targets.
+class CsrGraph
+{
+public:
+    struct Neighbors {
+        const uint32_t* first;
+        const uint32_t* last;
+        const uint32_t* begin() const { return first; }
+        const uint32_t* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+    };
+
+    // `ids` sorted ascending; links(i) lists the node ids vertex i links to.
+    // Every link becomes an edge both ways; links to unknown ids and
+    // self-links are dropped. `info(a, b)` gives the attributes of the link
+    // between node ids a and b; without it every edge is manual, weight 1.
+    void build(std::vector<uint32_t> ids, const std::function<const std::vector<int>&(size_t)>& links,
+               const std::function<EdgeInfo(uint32_t, uint32_t)>& info = nullptr);
+    void clear();
+
+    size_t vertexCount() const { return ids_.size(); }
+    size_t edgeCount() const { return targets_.size() / 2; } // Undirected
+
+    uint32_t nodeId(uint32_t vertex) const { return ids_[vertex]; }
+    int vertexOf(uint32_t nodeId) const; // -1 if absent
+    const std::vector<uint32_t>& nodeIds() const { return ids_; }
+
+    Neighbors neighbors(uint32_t vertex) const {
+        return {targets_.data() + offsets_[vertex], targets_.data() + offsets_[vertex + 1]};
+    }
+    uint32_t degree(uint32_t vertex) const { return static_cast<uint32_t>(offsets_[vertex + 1] - offsets_[vertex]); }
+    uint32_t degree(uint32_t vertex, const EdgeFilter& filter) const; // Edges the filter accepts
+
+    // Edge e of vertex v is in [edgeBegin(v), edgeEnd(v))
+    uint64_t edgeBegin(uint32_t vertex) const { return offsets_[vertex]; }
+    uint64_t edgeEnd(uint32_t vertex) const { return offsets_[vertex + 1]; }
+    uint32_t target(uint64_t edge) const { return targets_[edge]; }
+    float weight(uint64_t edge) const { return weights_.empty() ? 1.0f : weights_[edge]; }
+    uint8_t edgeTypes(uint64_t edge) const { return types_.empty() ? static_cast<uint8_t>(EDGE_MANUAL) : types_[edge]; }
+    bool accepts(uint64_t edge, const EdgeFilter& filter) const {
+        return filter.all() || filter.accepts(weight(edge), edgeTypes(edge));
+    }
+
+    const std::vector<uint64_t>& offsets() const { return offsets_; }
+    const std::vector<uint32_t>& targets() const { return targets_; }
+
+private:
+    std::vector<uint32_t> ids_;     // Vertex -> node id, ascending
+    std::vector<uint64_t> offsets_{0}; // vertexCount() + 1 entries
+    std::vector<uint32_t> targets_;
+    std::vector<float> weights_;    // Parallel to targets_, empty if built without info
+    std::vector<uint8_t> types_;
+};
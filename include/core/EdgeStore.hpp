@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Where a link came from; one link can carry several (bit flags)
+enum EdgeType : uint8_t {
+    EDGE_MANUAL = 1 << 0,    // API / LinkedNodes edits
+    EDGE_TAG = 1 << 1,       // Tag Jaccard similarity
+    EDGE_EMBEDDING = 1 << 2, // Embedding cosine similarity
+    EDGE_ALL_TYPES = EDGE_MANUAL | EDGE_TAG | EDGE_EMBEDDING
+};
+
+// Attributes of one undirected link
+struct EdgeInfo {
+    float weight = 1.0f;     // Similarity score; 1 for manual links
+    uint32_t timestamp = 0;  // Unix seconds of the last write
+    uint8_t types = EDGE_MANUAL;
+};
+
+// Link to create with its score
+struct WeightedLink {
+    int from;
+    int to;
+    float weight;
+};
+
+// Which links a traversal or ranking may use
+struct EdgeFilter {
+    float minWeight = 0.0f;
+    uint8_t types = EDGE_ALL_TYPES;
+
+    bool all() const { return minWeight <= 0.0f && (types & EDGE_ALL_TYPES) == EDGE_ALL_TYPES; }
+    bool accepts(float weight, uint8_t edgeTypes) const { return weight >= minWeight && (edgeTypes & types); }
+};
+
+// Attributes of the links listed in LinkedNodes, keyed by the unordered
+// node id pair. Attributes live in packed columns (17 bytes per edge plus
+// the hash index) and are persisted as a binary sidecar file next to the
+// JSON database. Links without a record are manual links of weight 1.
+class EdgeStore
+{
+public:
+    // Adds `type` to the link a-b. A rescore by the only source of the link
+    // replaces its weight; a second source keeps the larger one. True if
+    // the record changed.
+    bool upsert(uint32_t a, uint32_t b, EdgeType type, float weight, uint32_t timestamp);
+    // Drops `type` from the link; true if no source is left (record removed)
+    bool removeType(uint32_t a, uint32_t b, EdgeType type);
+    bool erase(uint32_t a, uint32_t b);
+    void clear();
+
+    bool find(uint32_t a, uint32_t b, EdgeInfo& info) const; // False if the link has no record
+    EdgeInfo get(uint32_t a, uint32_t b) const; // Manual, weight 1 if absent
+    size_t size() const { return keys_.size(); }
+    // Node id pairs (smaller first) of links carrying `type`
+    std::vector<std::pair<uint32_t, uint32_t>> withType(EdgeType type) const;
+
+    bool save(const std::string& path) const; // Written to a temporary file, then renamed
+    bool load(const std::string& path);       // False (store left empty) if missing or corrupt
+
+    // "manual,tag,embedding" <-> flags; unknown names make parseTypes return 0
+    static uint8_t parseTypes(const std::string& list);
+    static std::vector<std::string> typeNames(uint8_t types);
+
+private:
+    std::unordered_map<uint64_t, uint32_t> slots_; // Pair key -> column index
+    std::vector<uint64_t> keys_;
+    std::vector<float> weights_;
+    std::vector<uint32_t> timestamps_;
+    std::vector<uint8_t> types_;
+
+    static uint64_t key(uint32_t a, uint32_t b) {
+        if (a > b) std::swap(a, b);
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+    void removeSlot(uint32_t slot); // Swaps the last record into the hole
+};
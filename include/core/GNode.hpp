@@ -2,7 +2,29 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <limits>
+#include <optional>
 #include <nlohmann/json.hpp>
+#include "core/TagDictionary.hpp"
+
+namespace whisperdb { namespace http { class JsonWriter; } }
+
+// Field projection for node serialization (bitmask)
+enum NodeField : uint32_t {
+    FIELD_ID           = 1u << 0,
+    FIELD_TITLE        = 1u << 1,
+    FIELD_COURSE       = 1u << 2,
+    FIELD_SUBJECT      = 1u << 3,
+    FIELD_DESCRIPTION  = 1u << 4,
+    FIELD_AUTHOR       = 1u << 5,
+    FIELD_DATE         = 1u << 6,
+    FIELD_TAGS         = 1u << 7,
+    FIELD_STORAGE_PATH = 1u << 8,
+    FIELD_LINKED_NODES = 1u << 9,
+    FIELD_EMBEDDING    = 1u << 10,
+    FIELD_COMMUNITY    = 1u << 11
+};
 
 class Node
 {
@@ -14,37 +36,63 @@ public:
    
     
     std::string to_str();
-    nlohmann::json to_json() const;
+    nlohmann::json to_json() const;                // All fields (persistence)
+    nlohmann::json to_json(uint32_t fields) const; // Only the projected fields are read
+    void writeJson(whisperdb::http::JsonWriter& out, uint32_t fields) const; // Same document, streamed
+
+    // Encoded to_json(fields) bytes, cached per projection until the node changes.
+    // The reference is only valid until the node changes or jsonFragment is called
+    // again with another mask (that call may evict this slot): copy it out first.
+    const std::string& jsonFragment(uint32_t fields) const;
+
+    static constexpr uint32_t ALL_FIELDS = (FIELD_COMMUNITY << 1) - 1;
+    static constexpr uint32_t DEFAULT_FIELDS = ALL_FIELDS & ~FIELD_EMBEDDING; // API responses
+
+    // Parse a projection list ("id,title,tags", "*" for all); nullopt on unknown field
+    static std::optional<uint32_t> parseFields(const std::string& list);
 
     // Getters
     int getId() const { return id; }
-    std::string getTitle() const { return title; }
+    const std::string& getTitle() const { return title; }
     int getCourse() const { return course; }
-    std::string getSubject() const { return subject; }
-    std::string getDescription() const { return description; }
-    std::string getAuthor() const { return author; }
-    std::string getDate() const { return date; }
-    std::vector<std::string> getTags() const { return tags; }
-    std::string getStoragePath() const { return storage_path; }
-    std::vector<int> getLinkedNodes() const { return LinkedNodes; }
-    std::vector<float> getEmbedding() const { return embedding; }
+    const std::string& getSubject() const { return subject; }
+    const std::string& getDescription() const { return description; }
+    const std::string& getAuthor() const { return author; }
+    const std::string& getDate() const { return date; }
+    int64_t getDateEpoch() const { return dateEpoch; }
+    bool hasDate() const { return dateEpoch != NO_DATE; }
+    const std::vector<std::string>& getTags() const { return tags; }
+    const std::vector<TagId>& getTagIds() const { return tagIds; } // Sorted, unique; empty until indexed
+    const std::string& getStoragePath() const { return storage_path; }
+    const std::vector<int>& getLinkedNodes() const { return LinkedNodes; }
+    const std::vector<float>& getEmbedding() const { return embedding; }
     bool hasEmbedding() const { return !embedding.empty(); }
+    int getCommunity() const { return community; }
 
     // Setters
-    void setTitle(const std::string& t) { title = t; }
-    void setCourse(int c) { course = c; }
-    void setSubject(const std::string& s) { subject = s; }
-    void setDescription(const std::string& d) { description = d; }
-    void setAuthor(const std::string& a) { author = a; }
-    void setDate(const std::string& d) { date = d; }
-    void setTags(const std::vector<std::string>& t) { tags = t; }
-    void setStoragePath(const std::string& path) { storage_path = path; }
-    void setLinkedNodes(const std::vector<int>& nodes) { LinkedNodes = nodes; }
-    void setEmbedding(const std::vector<float>& emb) { embedding = emb; }
+    void setTitle(const std::string& t) { title = t; invalidateJson(); }
+    void setCourse(int c) { course = c; invalidateJson(); }
+    void setSubject(const std::string& s) { subject = s; invalidateJson(); }
+    void setDescription(const std::string& d) { description = d; invalidateJson(); }
+    void setAuthor(const std::string& a) { author = a; invalidateJson(); }
+    void setDate(const std::string& d) { date = d; dateEpoch = parseDate(d).value_or(NO_DATE); invalidateJson(); }
+    void setTags(const std::vector<std::string>& t) { tags = t; tagIds.clear(); invalidateJson(); }
+    void setTagIds(std::vector<TagId> ids) { tagIds = std::move(ids); } // Assigned by GraphDB
+    void setStoragePath(const std::string& path) { storage_path = path; invalidateJson(); }
+    void setLinkedNodes(const std::vector<int>& nodes) { LinkedNodes = nodes; invalidateJson(); }
+    void setEmbedding(const std::vector<float>& emb) { embedding = emb; invalidateJson(); }
+    void setCommunity(int c) { community = c; invalidateJson(); } // Assigned by GraphDB
 
     // Update from JSON (partial update)
     void updateFromJson(const nlohmann::json& j);
 
+    // Parse "YYYY-MM-DD[ HH:MM[:SS]]" (also with 'T' separator) into seconds since epoch;
+    // anything else, including impossible days, is rejected. `wholeDay` is set when only
+    // the date was given. The wall-clock time is taken as-is (no timezone shift), which
+    // keeps ordering intact.
+    static std::optional<int64_t> parseDate(const std::string& s, bool* wholeDay = nullptr);
+    static constexpr int64_t NO_DATE = std::numeric_limits<int64_t>::min();
+
 private:
     int id; // Unique identifier for the node
     std::string title; // Title of the node (lecture, conspect, etc.)
@@ -53,9 +101,23 @@ private:
     std::string description; // Description of the node
     std::string author; // Author of the node
     std::string date; // Date of creation or last modification
+    int64_t dateEpoch = NO_DATE; // Parsed `date`, NO_DATE if missing or malformed
     std::vector<std::string> tags; // Tags associated with the node
+    std::vector<TagId> tagIds; // Same tags as ids in the owning GraphDB's TagDictionary
     std::string storage_path; // Path to the main file associated with this node
 
     std::vector<int> LinkedNodes; // List of connected node IDs
     std::vector<float> embedding; // Vector embedding for semantic similarity
+    int community = -1; // Louvain community label, -1 until detected
+
+    // Serialized fragments, one per recently used projection
+    struct JsonFragment {
+        uint32_t fields = 0;
+        std::string bytes;
+    };
+    static constexpr size_t MAX_JSON_FRAGMENTS = 4;
+    mutable std::vector<JsonFragment> jsonFragments_;
+    mutable size_t nextFragmentSlot_ = 0; // Round-robin eviction
+
+    void invalidateJson() { jsonFragments_.clear(); }
 };
\ No newline at end of file
@@ -3,8 +3,29 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <map>
+#include <set>
+#include <deque>
+#include <cstdint>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <nlohmann/json.hpp>
 #include "GNode.hpp"
+#include "QueryCache.hpp"
+#include "Bitmap.hpp"
+#include "QueryPlanner.hpp"
+#include "TagDictionary.hpp"
+#include "TagMatrix.hpp"
+#include "TagCooccurrence.hpp"
+#include "TagCompleter.hpp"
+#include "CsrGraph.hpp"
+#include "EdgeStore.hpp"
+#include "UnionFind.hpp"
+#include "Louvain.hpp"
+#include "LinkPrediction.hpp"
+#include "GraphLayout.hpp"
 
 // Forward declaration
 class FileStorage;
@@ -24,14 +45,28 @@ public:
     bool deleteNode(const std::string& id);
 
     // Query operations
+    // `fields` is a Node projection mask (see NodeField)
     nlohmann::json getAllNodes(
         const std::string& sortBy = "id",
         const std::string& order = "asc",
         int limit = -1,
-        int offset = 0
+        int offset = 0,
+        uint32_t fields = Node::ALL_FIELDS
     ) const;
 
     nlohmann::json findNodes(
+        const std::unordered_map<std::string, std::string>& filters,
+        const std::string& sortBy = "id",
+        const std::string& order = "asc",
+        int limit = -1,
+        int offset = 0,
+        uint32_t fields = Node::ALL_FIELDS,
+        nlohmann::json* explain = nullptr // Receives the chosen plan and timings, or cacheHit if cached
+    ) const;
+
+    // Same query as findNodes, returning the page's nodes for streaming
+    // serialization; only the ids are cached. Pointers are valid until the next mutation.
+    std::vector<const Node*> queryNodes(
         const std::unordered_map<std::string, std::string>& filters,
         const std::string& sortBy = "id",
         const std::string& order = "asc",
@@ -39,17 +74,112 @@ public:
         int offset = 0
     ) const;
 
+    // Borrow a node without copying it; nullptr if not found
+    const Node* getNode(const std::string& id) const;
+
+    // Serialize a single node without copying it; throws if not found
+    nlohmann::json getNodeJson(const std::string& id, uint32_t fields = Node::ALL_FIELDS) const;
+
+    // Embeddings read from the nodes in place, by ascending id; ids of nodes
+    // without one go to `missing` if given. Pointers are valid until the next mutation.
+    std::vector<std::pair<int, const std::vector<float>*>> getEmbeddings(std::vector<int>* missing = nullptr) const;
+
     // Count nodes (with optional filters)
     int countNodes(const std::unordered_map<std::string, std::string>& filters = {}) const;
 
+    // Counts per subject, author, course and tag over the nodes matching `filters`
+    // (same filters as findNodes); `limit` caps the buckets per facet
+    nlohmann::json getFacets(const std::unordered_map<std::string, std::string>& filters = {}, int limit = -1) const;
+
     // Tag bank operations
-    std::vector<std::string> getTagBank() const { return tagBank_; }
+    const std::vector<std::string>& getTagBank() const { return tags_.bank(); }
+    bool isInTagBank(const std::string& tag) const { return tags_.inBank(tag); }
+    const TagDictionary& getTagDictionary() const { return tags_; }
     void setTagBank(const std::vector<std::string>& tags);
     void addToTagBank(const std::vector<std::string>& newTags);
+    // Tag bank entries starting with `prefix`, most used first; `matches` gets the
+    // number of bank tags with that prefix
+    std::vector<TagCompleter::Entry> completeTags(const std::string& prefix, size_t limit, size_t* matches = nullptr) const;
     std::vector<int> findNodesByTag(const std::string& tag) const;
     std::vector<int> findNodesWithSharedTags(int nodeId) const;
     std::vector<int> findNodesWithJaccardSimilarity(int nodeId, float threshold = 0.3f) const;
     static float calculateJaccardSimilarity(const std::vector<std::string>& tags1, const std::vector<std::string>& tags2);
+    // Batch Jaccard of one node's tags against every other node: (id, score)
+    // pairs with score >= threshold and > 0, best first
+    std::vector<std::pair<int, float>> scoreTagSimilarity(int nodeId, float threshold = 0.0f) const;
+    // Exact tag Jaccard of two nodes (0 if either is missing)
+    float tagSimilarity(int nodeId1, int nodeId2) const;
+    // Tags that appear together with `tag` on at least `minCount` nodes, ranked by PMI
+    std::vector<TagScore> relatedTags(const std::string& tag, size_t limit = 10, uint32_t minCount = 1) const;
+    // Tags to suggest next for a node already carrying `tags` (unknown names are ignored)
+    std::vector<TagScore> suggestTags(const std::vector<std::string>& tags, size_t limit = 10, uint32_t minCount = 1) const;
+
+    // Link operations
+    // Add bidirectional links in memory, then save once; returns the number of new edges
+    int addLinks(const std::vector<std::pair<int, int>>& edges); // Manual, weight 1
+    // Same, recording `type` and the score on each link (existing links are rescored)
+    int addLinks(const std::vector<WeightedLink>& links, EdgeType type);
+    // Make `links` the complete set of `type` links: others lose the type and are
+    // unlinked if no other source keeps them. Returns (created, removed).
+    std::pair<int, int> replaceLinks(const std::vector<WeightedLink>& links, EdgeType type);
+    EdgeInfo getEdge(int nodeId1, int nodeId2) const; // Manual, weight 1 if no record
+    size_t getEdgeRecordCount() const { return edgeStore_.size(); }
+
+    // Link consistency: both ends list every link, no link points at a
+    // missing node, no edge record outlives its link. A sweep over a
+    // snapshot runs on a background thread after load and every
+    // LINK_CHECK_INTERVAL link changes; what it finds is re-checked and
+    // repaired on the request thread. `wait` blocks until the sweep is applied.
+    void checkLinks(bool wait = false);
+    nlohmann::json getLinkCheckStatus();
+    // Undirected snapshot of all LinkedNodes with edge weights and types,
+    // rebuilt on first use after links change
+    const CsrGraph& getLinkGraph() const;
+    uint64_t getLinkGeneration() const { return linkGeneration_; }
+    uint64_t getTagGeneration() const { return tagGeneration_; }
+
+    // Connected components of the link graph. Adding links only merges
+    // components, so it updates a union-find in place; removing links or
+    // nodes marks it for a rebuild on next use.
+    int componentOf(int nodeId) const;      // Representative node id, -1 if no such node
+    size_t componentSize(int nodeId) const; // 0 if no such node
+    size_t componentCount() const;
+
+    // PageRank over the link graph, kept as a column by node id (?sort=rank).
+    // Once requested it is recomputed on a background thread whenever links
+    // change, warm-started from the previous column; the first computation
+    // runs inline.
+    void scheduleRankRefresh();
+    float getRank(int nodeId) const;        // 0 if unknown or not computed yet
+    uint64_t getRankVersion() const { return rankVersion_; }
+    nlohmann::json getRankStatus() const;
+    std::vector<std::pair<int, double>> topRanked(size_t limit) const; // Empty until the first column
+    // Personalized PageRank seeded at `nodeId`, computed on demand; best first, seed excluded
+    std::vector<std::pair<int, double>> personalizedRank(int nodeId, size_t limit, const EdgeFilter& filter = {}) const;
+
+    // Louvain communities of the link graph. Each node gets the smallest
+    // node id of its community as `community` (persisted, ?community=
+    // filter). Detection runs in the background; labels are swapped in and
+    // saved on the next sync. Nodes added later stay unlabeled until the
+    // next run.
+    nlohmann::json detectCommunities(const Louvain::Options& options); // Starts a run unless one is going
+    nlohmann::json getCommunityStatus();
+    // Largest communities first, with their most common tags
+    nlohmann::json listCommunities(size_t limit, size_t tagLimit = 5);
+
+    // Link suggestions from common neighbors; vertices are those of getLinkGraph()
+    LinkPrediction::Result suggestLinks(int nodeId, const LinkPrediction::Options& options) const;
+    // Top suggestions of every vertex, computed on the pool and kept until
+    // links or the options change; `elapsedMs` gets the compute time (0 if cached)
+    const std::vector<std::vector<LinkPrediction::Suggestion>>& suggestAllLinks(
+        const LinkPrediction::Options& options, double* elapsedMs = nullptr) const;
+
+    // Force-directed layout of the link graph for the web client. Computed
+    // on a background thread once requested; after links change the next
+    // job starts from the previous positions and only refines. Returns the
+    // newest ready layout without waiting: nullptr until the first one is done.
+    std::shared_ptr<const LayoutSnapshot> getLayout();
+    nlohmann::json getLayoutStatus();
     
     // File operations
     std::string addFileToNode(const std::string& nodeId, const std::string& filename, const std::string& content);
@@ -60,6 +190,15 @@ public:
     // Getters and setters
     int getSize() const { return size; }
     void setSize(int new_size) { size = new_size; }
+
+    // Query result cache
+    uint64_t getGeneration() const { return generation_; }
+    nlohmann::json getQueryCacheStats() const { return queryCache_.stats(); }
+
+    // Parallel scan tuning: threads = 0 uses the whole pool, 1 disables it
+    void setScanThreads(size_t threads) { scanThreads_ = threads; }
+    size_t getScanThreads() const;
+    void setParallelScanThreshold(size_t rows) { parallelScanThreshold_ = rows; }
     
     // Persistence
     void saveToJson();
@@ -67,12 +206,184 @@ public:
 private:
     std::unordered_map<std::string, Node*> nodes; // Map of nodes by their unique ID
     std::unordered_map<std::string, std::vector<std::string>> nodeFiles; // Maps node ID to list of file paths
-    std::vector<std::string> tagBank_; // Global tag bank for AI-generated tags
+    TagDictionary tags_; // Every tag seen (stable ids, usage counts) plus the AI tag bank
     int size;
     std::unique_ptr<FileStorage> fileStorage;
+    // Secondary indexes: postings of node ids per field value
+    std::vector<Node*> byId_;                             // Indexed nodes by id, null for gaps; ids stay small
+    RoaringBitmap allNodes_;
+    std::unordered_map<std::string, RoaringBitmap> subjectIndex_;
+    std::unordered_map<std::string, RoaringBitmap> authorIndex_;
+    std::map<int, RoaringBitmap> courseIndex_;            // Ordered: supports course ranges
+    std::map<int, RoaringBitmap> communityIndex_;         // Labeled nodes only
+    std::set<std::pair<int64_t, uint32_t>> dateIndex_;    // (date epoch, node id), ordered for ranges and sorting
+    std::vector<RoaringBitmap> tagPostings_;              // Indexed by TagId
+    TagCooccurrence tagCooccurrence_;                     // Pair counts of tags on the same node
+    EdgeStore edgeStore_;                                 // Type, weight and time per link
+    std::unordered_map<int, std::vector<int>> incoming_;  // Link target -> nodes listing it
+    bool edgesDirty_ = false;                             // Edge sidecar needs rewriting
+
+    uint64_t generation_ = 0; // Bumped on every mutation, invalidates cached query results
+    mutable QueryCache queryCache_;
+    size_t scanThreads_;
+    uint64_t tagGeneration_ = 0;              // Bumped when any node's tag set changes
+    mutable TagMatrix tagMatrix_;             // Built lazily from node tag ids
+    mutable uint64_t tagMatrixGeneration_ = UINT64_MAX;
+    mutable std::vector<uint32_t> tagMatrixDirty_; // Nodes whose tag row is out of date in tagMatrix_
+    uint64_t linkGeneration_ = 0;             // Bumped when any node's links (or the node set) change
+    mutable CsrGraph linkGraph_;
+    mutable uint64_t linkGraphGeneration_ = UINT64_MAX;
+    mutable UnionFind components_;            // Over node ids
+    mutable bool componentsDirty_ = true;     // Something was unlinked: rebuild before use
+    mutable size_t componentMerges_ = 0;      // Successful unions; components = nodes - merges
+    uint32_t maxNodeId_ = 0;                  // Highest node id indexed so far
+    uint64_t tagBankGeneration_ = 0;          // Bumped when the tag bank changes
+    mutable TagCompleter tagCompleter_;       // Bank tags weighted by usage, built lazily
+    mutable std::pair<uint64_t, uint64_t> tagCompleterGeneration_{UINT64_MAX, UINT64_MAX}; // (tag, bank)
+    size_t parallelScanThreshold_;
+
+    // Failures of a background job: the next run waits a delay that doubles per failure
+    struct JobRetry {
+        std::string error;  // Last failure, cleared by a successful run
+        unsigned failures = 0;
+        std::chrono::steady_clock::time_point notBefore;
+
+        void failed(const std::string& message);
+        void succeeded();
+        bool due() const { return std::chrono::steady_clock::now() >= notBefore; }
+        void report(nlohmann::json& status) const;
+    };
+
+    // PageRank column and the background job refreshing it
+    struct RankJob {
+        std::mutex mutex;
+        bool done = false;
+        std::string error;           // Empty unless the job failed
+        uint64_t linkGeneration = 0; // Links the job was started from
+        std::vector<float> column;   // By node id
+        int iterations = 0;
+        double residual = 0;
+        double elapsedMs = 0;
+    };
+    mutable std::vector<float> rankColumn_;
+    mutable uint64_t rankVersion_ = 0;                   // Bumped when a new column is installed
+    mutable uint64_t rankLinkGeneration_ = UINT64_MAX;   // Links the column reflects
+    mutable bool rankEnabled_ = false;                   // No background work until ranks are used
+    mutable std::shared_ptr<RankJob> rankJob_;
+    mutable std::thread rankThread_;
+    mutable nlohmann::json rankStats_ = nlohmann::json::object(); // Last installed job
+    mutable JobRetry rankRetry_;
+
+    // Community labels and the background detection run
+    struct CommunityJob {
+        std::mutex mutex;
+        bool done = false;
+        std::string error;                          // Empty unless the run failed
+        uint64_t linkGeneration = 0;
+        double resolution = 1.0;
+        std::vector<std::pair<uint32_t, int>> labels; // (node id, label)
+        size_t communities = 0;
+        double modularity = 0.0;
+        int levels = 0;
+        int sweeps = 0;
+        double elapsedMs = 0;
+    };
+    nlohmann::json communityStats_ = nlohmann::json::object(); // Last detection run
+    uint64_t communityLinkGeneration_ = UINT64_MAX;             // Links it ran on
+    std::shared_ptr<CommunityJob> communityJob_;
+    std::thread communityThread_;
+
+    // Last batch of link suggestions
+    struct LinkSuggestionCache {
+        uint64_t linkGeneration = UINT64_MAX;
+        LinkPrediction::Options options;
+        std::vector<std::vector<LinkPrediction::Suggestion>> byVertex;
+    };
+    mutable LinkSuggestionCache linkSuggestions_;
+
+    // Layout served to the web client and the background job refining it
+    struct LayoutJob {
+        std::mutex mutex;
+        bool done = false;
+        uint64_t linkGeneration = 0;
+        std::shared_ptr<LayoutSnapshot> snapshot; // Null if the job failed
+        std::string error;
+    };
+    std::shared_ptr<const LayoutSnapshot> layout_;
+    uint64_t layoutLinkGeneration_ = UINT64_MAX;
+    bool layoutEnabled_ = false;
+    std::shared_ptr<LayoutJob> layoutJob_;
+    std::thread layoutThread_;
+    JobRetry layoutRetry_;
+
+    // Background link consistency sweep
+    struct LinkCheckJob {
+        std::mutex mutex;
+        bool done = false;
+        std::vector<std::pair<int, int>> dangling;    // (from, missing node)
+        std::vector<std::pair<int, int>> asymmetric;  // from lists to, not the reverse
+        std::vector<std::pair<uint32_t, uint32_t>> orphanRecords;
+        size_t nodes = 0;
+        size_t links = 0;
+        double elapsedMs = 0;
+    };
+    std::shared_ptr<LinkCheckJob> linkCheckJob_;
+    std::thread linkCheckThread_;
+    uint64_t linkCheckGeneration_ = 0;                    // Links as of the last sweep
+    nlohmann::json linkCheckReport_ = nlohmann::json::object();
     
     void initGraphDB();
     void createJson();
     void loadFromJson();
     std::string generateNodeId();
-};
\ No newline at end of file
+    void bumpGeneration() { ++generation_; }
+
+    // Index maintenance
+    void indexNode(Node& node); // Also assigns the node's tag ids
+    void unindexNode(const Node& node);
+    void clearIndexes();
+    Node* nodeById(uint32_t id) const;
+    const TagMatrix& tagMatrix() const; // Changed rows replayed, or rebuilt, when the tag generation moved
+    void touchTagRow(uint32_t id);      // Queue a node's row for the next tagMatrix()
+    const TagCompleter& tagCompleter() const; // Rebuilt when usage or the bank changed
+    int insertLinks(const std::vector<WeightedLink>& links, EdgeType type, bool& changed); // No save
+    void forgetEdges(int nodeId, const std::vector<int>& links); // Drop records no side lists anymore
+    // Edit one LinkedNodes list and the reverse index with it; true if it changed
+    bool appendLink(Node& node, int to);
+    bool dropLink(Node& node, int to);
+    void dropIncoming(int target, int source);
+    bool syncLinkCheck();     // Apply a finished sweep, start one if due; true if lists were repaired
+    void startLinkCheck();
+    bool installLinkCheck();  // Joins the sweep thread
+    void linkComponents(int nodeId1, int nodeId2); // Merge unless a rebuild is pending
+    UnionFind& components() const;                 // Rebuilt from the link graph when dirty
+    void prepareRanks() const;  // Enable ranks and start the first column if there is none
+    void syncRanks() const;     // Install a finished job; start one if links moved
+    void startRankJob() const;
+    void installRankJob() const; // Joins the job thread
+    void syncCommunities();      // Install a finished detection run
+    void installCommunityJob();  // Joins the job thread
+    void syncLayout();           // Install a finished layout; start one if links moved
+    void startLayoutJob();
+    void installLayoutJob();     // Joins the job thread
+
+    // Query evaluation: filters become predicates with cardinality estimates,
+    // QueryPlanner picks the access path, executePlan runs it
+    struct ParsedFilters {
+        std::vector<QueryPredicate> predicates;
+        bool matchesNothing = false; // Some indexed filter is provably empty
+    };
+    ParsedFilters parseFilters(const std::unordered_map<std::string, std::string>& filters) const;
+    RoaringBitmap matchingBitmap(const ParsedFilters& parsed) const;
+    const RoaringBitmap& postingFor(const QueryPredicate& p, std::deque<RoaringBitmap>& scratch) const;
+    bool hasOrderedIndex(const std::string& sortBy) const;
+    std::vector<Node*> runQuery(const std::unordered_map<std::string, std::string>& filters,
+                                const std::string& sortBy, const std::string& order, int limit, int offset,
+                                QueryPlan& plan, ParsedFilters& parsed) const;
+    std::vector<Node*> executePlan(QueryPlan& plan, const std::vector<QueryPredicate>& predicates, size_t needed) const;
+    std::vector<Node*> parallelScan(const RoaringBitmap& candidates, QueryPlan& plan,
+                                    const std::vector<QueryPredicate>& predicates, size_t needed) const;
+    uint64_t countMatches(const RoaringBitmap& candidates,
+                          const std::vector<QueryPredicate>& predicates, const std::vector<size_t>& which) const;
+    static bool matchesAll(const Node& node, const std::vector<QueryPredicate>& predicates, const std::vector<size_t>& which);
+};
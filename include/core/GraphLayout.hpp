@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "core/CsrGraph.hpp"
+
+// Positions of one layout run, by vertex of the graph it ran on
+struct LayoutSnapshot {
+    std::vector<uint32_t> ids;    // Node id by vertex, ascending
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<uint32_t> edges;  // Vertex pairs a0, b0, a1, b1, ... with a < b
+    uint64_t version = 0;
+    uint64_t linkGeneration = 0;  // Links it was computed from
+    int iterations = 0;
+    double elapsedMs = 0;
+};
+
+// ForceAtlas2-style force-directed layout. Vertices repel in proportion to
+// (degree + 1) of both ends, links pull linearly with their weight and a
+// weak gravity keeps components together. Repulsion goes through a
+// Barnes-Hut quadtree rebuilt every iteration; forces and moves are
+// computed on the shared pool. Step sizes adapt per vertex to how much
+// its force oscillates, so a warm start converges in few iterations.
+class GraphLayout
+{
+public:
+    struct Options {
+        int iterations = 100;
+        double repulsion = 10.0;
+        double gravity = 1.0;
+        double theta = 1.2;           // Barnes-Hut opening criterion: larger is coarser
+        double jitterTolerance = 1.0; // Oscillation accepted before slowing down
+    };
+
+    // Runs `iterations` steps starting from x, y (by vertex). NaN entries,
+    // or all of them when the sizes do not match, are placed first: next
+    // to already placed neighbors, else at random. Returns the steps run.
+    static int run(const CsrGraph& graph, const Options& options, std::vector<float>& x, std::vector<float>& y);
+};
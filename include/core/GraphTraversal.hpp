@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "core/CsrGraph.hpp"
+
+// Bounded breadth-first traversals over the link graph snapshot.
+// All results use node ids. Work is capped by node/visit limits rather than
+// graph size, so latency stays bounded on dense regions. Only edges the
+// filter accepts are followed.
+class GraphTraversal
+{
+public:
+    struct Edge {
+        int from;   // Smaller id
+        int to;
+        float weight;
+        uint8_t types;
+    };
+
+    struct Neighborhood {
+        std::vector<std::vector<int>> levels;     // levels[d]: nodes at distance d (levels[0] = center)
+        std::vector<Edge> edges;                  // Accepted links among returned nodes
+        bool truncated = false;                   // Stopped at the node limit
+    };
+
+    struct Path {
+        bool found = false;
+        std::vector<int> nodes;  // from .. to, empty if not found
+        size_t visited = 0;      // Vertices reached by both searches
+        bool truncated = false;  // Gave up at the visit limit
+    };
+
+    // Nodes within `depth` hops of `nodeId`, at most `limit` of them (BFS order)
+    static Neighborhood neighborhood(const CsrGraph& graph, int nodeId, int depth, size_t limit,
+                                     const EdgeFilter& filter = {});
+
+    // Shortest path by bidirectional BFS, always expanding the smaller frontier;
+    // at most `maxVisited` vertices are reached in total
+    static Path shortestPath(const CsrGraph& graph, int from, int to, size_t maxVisited,
+                             const EdgeFilter& filter = {});
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core/CsrGraph.hpp"
+
+// Link prediction from common neighbors: candidates for a vertex are the
+// vertices two hops away that it is not linked to yet. Expansion is
+// bounded: neighbors are walked lowest degree first (they say the most
+// about the pair) until `maxPaths` two-hop paths were visited, so a hub
+// in the neighborhood cannot make one query scan the graph.
+class LinkPrediction
+{
+public:
+    enum class Score {
+        ADAMIC_ADAR,         // Sum of 1 / log(degree) over common neighbors
+        JACCARD,             // Common / union of both neighbor sets
+        RESOURCE_ALLOCATION  // Sum of 1 / degree over common neighbors
+    };
+
+    struct Options {
+        Score score = Score::ADAMIC_ADAR;
+        size_t limit = 10;           // Suggestions per vertex
+        size_t maxPaths = 1u << 14;  // Two-hop paths visited per vertex
+        EdgeFilter filter;           // Links that count as adjacency
+    };
+
+    struct Suggestion {
+        uint32_t vertex;
+        double score;
+        uint32_t common; // Common neighbors seen
+    };
+
+    struct Result {
+        std::vector<Suggestion> suggestions; // Best first
+        uint64_t paths = 0;                  // Two-hop paths visited
+        bool truncated = false;              // Some neighbors were left out by maxPaths
+    };
+
+    static Result suggest(const CsrGraph& graph, uint32_t vertex, const Options& options);
+    // Top suggestions of every vertex (by vertex), vertices spread over the pool
+    static std::vector<std::vector<Suggestion>> suggestAll(const CsrGraph& graph, const Options& options);
+
+    // "adamic_adar", "jaccard", "resource_allocation"; false if unknown
+    static bool parseScore(const std::string& name, Score& score);
+    static const char* scoreName(Score score);
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "core/CsrGraph.hpp"
+
+// Louvain community detection over the weighted link graph.
+// Local moving runs on the shared pool: vertices of a sweep are claimed in
+// morsels and moved asynchronously against atomic community totals. Each
+// level then folds communities into vertices of a smaller graph, until
+// nothing moves. Modularity uses a resolution parameter: above 1 gives
+// more, smaller communities; below 1 fewer, larger ones.
+class Louvain
+{
+public:
+    struct Options {
+        double resolution = 1.0;
+        int maxLevels = 10;
+        int maxSweeps = 16;       // Local moving sweeps per level
+        double minGain = 1e-6;    // Stop sweeping once modularity improves by less
+        EdgeFilter filter;        // Links taken into account; weights come from the graph
+    };
+
+    struct Result {
+        std::vector<uint32_t> community; // By vertex, dense ids 0..communities-1
+        size_t communities = 0;
+        double modularity = 0.0;
+        int levels = 0;
+        int sweeps = 0;                  // Over all levels
+    };
+
+    static Result run(const CsrGraph& graph, const Options& options);
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "core/CsrGraph.hpp"
+
+// PageRank over the undirected link graph (each link counts both ways).
+// Pull-style power iteration parallelized over vertices on the shared pool;
+// rank of dangling vertices is redistributed through the teleport vector.
+class PageRank
+{
+public:
+    struct Options {
+        double damping = 0.85;
+        double tolerance = 1e-6;  // Stop when the L1 change of an iteration drops below
+        int maxIterations = 100;
+        int source = -1;          // Vertex to teleport to (personalized PageRank), -1 = uniform
+        EdgeFilter filter;        // Links the walk may follow; the rest count as absent
+    };
+
+    struct Result {
+        std::vector<double> scores; // By vertex, sums to 1
+        int iterations = 0;
+        double residual = 0.0;
+    };
+
+    // `warmStart` (by vertex) seeds the iteration, e.g. the previous scores
+    // after a few links changed; ignored if its size does not match
+    static Result compute(const CsrGraph& graph, const Options& options, const std::vector<double>& warmStart = {});
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+// LRU cache for query results, bounded by entry count and by the approximate
+// bytes of the cached values; a single result above a quarter of the byte
+// budget (a huge unpaged listing) is not cached at all.
+// Every entry remembers the database generation it was computed at;
+// a lookup with a newer generation treats the entry as stale and drops it.
+class QueryCache
+{
+public:
+    explicit QueryCache(size_t capacity = 256, size_t maxBytes = 64 << 20);
+
+    // Copy cached value into `out` if present and still valid for `generation`
+    bool get(const std::string& key, uint64_t generation, nlohmann::json& out);
+    void put(const std::string& key, uint64_t generation, nlohmann::json value);
+    void clear();
+
+    size_t size() const { return lru_.size(); }
+    size_t capacity() const { return capacity_; }
+    void setCapacity(size_t capacity);
+    size_t bytes() const { return bytes_; }
+
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+    nlohmann::json stats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        uint64_t generation;
+        nlohmann::json value;
+        size_t bytes;
+    };
+
+    std::list<Entry> lru_; // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    size_t capacity_;
+    size_t maxBytes_;
+    size_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+
+    void evict();
+    void erase(std::list<Entry>::iterator it);
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "core/Bitmap.hpp"
+
+// Single filter condition of a node query
+struct QueryPredicate {
+    std::string field;      // subject, author, tag, course, course_range, date_range, title
+    std::string value;      // Equality / substring operand
+    int64_t lo = 0;         // Inclusive bounds for range predicates
+    int64_t hi = 0;
+    const RoaringBitmap* posting = nullptr; // Equality posting, when indexed
+    uint64_t estimate = 0;  // Estimated number of matching rows
+    bool indexed = false;   // Can be answered from an index
+
+    std::string describe() const;
+};
+
+enum class AccessPath {
+    FULL_SCAN,           // Visit every node, check all predicates
+    INDEX_PROBE,         // Visit one posting, check the remaining predicates per row
+    BITMAP_INTERSECTION, // AND all indexed postings, check residual predicates per row
+    ORDERED_INDEX_WALK   // Walk the sort column's index in order, stop after offset+limit
+};
+
+const char* to_string(AccessPath path);
+
+struct QueryPlan {
+    AccessPath access = AccessPath::FULL_SCAN;
+    std::vector<size_t> indexed;  // Predicates answered from indexes, in probe order
+    std::vector<size_t> residual; // Predicates checked per visited row
+    std::string sortBy = "id";
+    bool ascending = true;
+    bool sortedByIndex = false;   // Rows come out of the access path already ordered
+    bool sortedByScan = false;    // Parallel scan merged sorted runs (and applied top-k)
+    double estimatedRows = 0;
+    double estimatedCost = 0;
+    std::vector<std::pair<AccessPath, double>> alternatives; // Costed candidates
+
+    // Filled in during execution
+    bool cacheHit = false;
+    uint64_t rowsExamined = 0;
+    uint64_t rowsMatched = 0;
+    uint64_t rowsReturned = 0;
+    size_t workers = 1;           // Scan threads used
+    double planUs = 0;
+    double executeUs = 0;
+    double sortUs = 0;
+    double serializeUs = 0;
+
+    nlohmann::json to_json(const std::vector<QueryPredicate>& predicates) const;
+};
+
+// Chooses the access path for a node query from per-index cardinality estimates
+class QueryPlanner
+{
+public:
+    struct Input {
+        uint64_t totalRows = 0;
+        const std::vector<QueryPredicate>* predicates = nullptr;
+        std::string sortBy = "id";
+        bool ascending = true;
+        int limit = -1;
+        int offset = 0;
+        bool orderedIndex = false; // The sort column has an ordered index covering all rows
+    };
+
+    static QueryPlan plan(const Input& input);
+
+    // Cost model weights (relative units: one node fetch + predicate check = 1)
+    static constexpr double ROW_COST = 1.0;
+    static constexpr double BITMAP_ELEMENT_COST = 0.02;
+    static constexpr double RANGE_BUILD_COST = 0.1;
+    static constexpr double COMPARE_COST = 0.2;
+    static constexpr double SUBSTRING_SELECTIVITY = 0.1; // Guess for title matches
+
+private:
+    static double sortCost(double rows, int limit, int offset);
+    static double buildCost(const QueryPredicate& p);
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "core/TagDictionary.hpp"
+
+// Prefix completion over a fixed set of tags, best weight first.
+// Tags are kept sorted by name, so a prefix maps to one contiguous range;
+// a sparse table of range maxima over the weights then yields the top k
+// of that range in O(k log k) without walking or copying the whole range.
+class TagCompleter
+{
+public:
+    struct Entry {
+        std::string name;
+        TagId id;
+        uint32_t weight; // Usage count
+    };
+
+    void build(std::vector<Entry> entries);
+    void clear();
+
+    size_t size() const { return entries_.size(); }
+
+    // [begin, end) of the entries starting with `prefix`
+    std::pair<size_t, size_t> range(std::string_view prefix) const;
+
+    // Up to k entries starting with `prefix`, highest weight first, ties by name
+    std::vector<const Entry*> complete(std::string_view prefix, size_t k) const;
+
+private:
+    std::vector<Entry> entries_;                 // Sorted by name
+    std::vector<std::vector<uint32_t>> maxIndex_; // maxIndex_[j][i]: best entry in [i, i + 2^j)
+
+    uint32_t better(uint32_t a, uint32_t b) const;
+    uint32_t best(size_t begin, size_t end) const; // end > begin
+};
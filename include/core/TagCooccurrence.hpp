@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "core/TagDictionary.hpp"
+
+// Ranked co-occurring tag
+struct TagScore {
+    TagId tag = TagDictionary::NO_TAG;
+    // For suggestions all three are summed over the context tags
+    uint32_t count = 0; // Nodes carrying both tags
+    double pmi = 0;     // log2(lift)
+    double lift = 0;    // P(a,b) / (P(a) P(b))
+};
+
+// Sparse symmetric tag x tag matrix of how many nodes carry both tags.
+// Updated per node tag set, so related-tag queries only walk one row.
+class TagCooccurrence
+{
+public:
+    void addSet(const std::vector<TagId>& tags);    // Sorted, unique
+    void removeSet(const std::vector<TagId>& tags);
+    void clear() { rows_.clear(); }
+
+    uint32_t count(TagId a, TagId b) const;
+    size_t degree(TagId tag) const { return tag < rows_.size() ? rows_[tag].size() : 0; }
+
+    // Tags co-occurring with `tag` in at least `minCount` nodes, best PMI first.
+    // Document frequencies come from `dict` usage; `total` is the number of nodes.
+    std::vector<TagScore> related(TagId tag, const TagDictionary& dict, uint64_t total,
+                                  size_t k, uint32_t minCount = 1) const;
+
+    // Tags that go with all of `context`: summed positive PMI over the context,
+    // context tags themselves excluded
+    std::vector<TagScore> suggest(const std::vector<TagId>& context, const TagDictionary& dict, uint64_t total,
+                                  size_t k, uint32_t minCount = 1) const;
+
+private:
+    std::vector<std::unordered_map<TagId, uint32_t>> rows_; // Indexed by TagId
+
+    static double lift(uint32_t both, uint32_t a, uint32_t b, uint64_t total);
+    static void topK(std::vector<TagScore>& scores, size_t k);
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using TagId = uint32_t;
+
+// Interned tag names with stable ids.
+// Ids are assigned in insertion order and never reused, so they can be
+// persisted and used as array indexes (postings, bitsets). Tracks how many
+// nodes carry each tag and which tags belong to the AI tag bank.
+class TagDictionary
+{
+public:
+    static constexpr TagId NO_TAG = std::numeric_limits<TagId>::max();
+
+    // Id of `name`, adding it if missing
+    TagId intern(const std::string& name);
+    // Id of `name` or NO_TAG
+    TagId find(const std::string& name) const;
+    bool contains(const std::string& name) const { return find(name) != NO_TAG; }
+
+    const std::string& name(TagId id) const { return names_[id]; }
+    const std::vector<std::string>& names() const { return names_; } // Indexed by id
+    size_t size() const { return names_.size(); }
+
+    // Number of nodes carrying the tag
+    uint32_t usage(TagId id) const { return usage_[id]; }
+    void addUsage(TagId id) { ++usage_[id]; }
+    void removeUsage(TagId id) { if (usage_[id] > 0) --usage_[id]; }
+    void resetUsage();
+
+    // Tag bank: tags offered to the tag generator, in the order they were added
+    bool addToBank(const std::string& name); // false if already there
+    bool inBank(const std::string& name) const;
+    const std::vector<std::string>& bank() const { return bank_; }
+    void clearBank();
+
+    void clear();
+
+private:
+    std::vector<std::string> names_;
+    std::vector<uint32_t> usage_;
+    std::vector<bool> inBank_;
+    std::unordered_map<std::string, TagId> ids_;
+    std::vector<std::string> bank_;
+};
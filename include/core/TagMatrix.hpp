@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "core/TagDictionary.hpp"
+
+// Tag sets of all nodes, scored by Jaccard against a query tag set.
+// Frequent tags are bit columns stored column-major: word w of every row
+// is contiguous ("plane" w), so a query touches only the planes where it
+// has bits, each in a straight AND + popcount loop (AVX2 when built with
+// it). Rare tags keep sorted row lists instead, so memory follows the
+// number of tag assignments, not rows x dictionary size.
+// Rows are updated one at a time; a removed node leaves an empty row
+// until the next build. Jaccard = |A & B| / (|A| + |B| - |A & B|).
+class TagMatrix
+{
+public:
+    struct Row {
+        uint32_t nodeId;
+        const std::vector<TagId>* tags; // Sorted, unique
+    };
+
+    void build(const std::vector<Row>& rows, size_t tagCount);
+    void clear();
+
+    // Replace one node's tag set (sorted, unique); a new node gets a new row
+    void update(uint32_t nodeId, const std::vector<TagId>& tags);
+    void remove(uint32_t nodeId);
+    // Updates left many empty rows, or tags in the wrong storage for their frequency
+    bool needsRebuild() const;
+
+    size_t rows() const { return nodeIds_.size(); }
+    size_t denseTags() const { return denseCount_; }
+    uint32_t nodeId(size_t row) const { return nodeIds_[row]; }
+    int rowOf(uint32_t nodeId) const; // -1 if absent
+
+    // Jaccard of `tags` (sorted, unique) against every row; out.size() == rows()
+    void scoreAll(const std::vector<TagId>& tags, std::vector<float>& out) const;
+    // Jaccard of two rows
+    float score(size_t a, size_t b) const;
+
+private:
+    size_t stride_ = 0;                       // Row capacity of each plane
+    size_t denseCount_ = 0;
+    std::vector<uint64_t> planes_;            // One plane of stride_ words per 64 dense tags
+    std::vector<int32_t> denseSlot_;          // By tag: bit column, -1 if kept as a row list
+    std::vector<std::vector<uint32_t>> postings_; // By rare tag: rows, ascending
+    std::vector<uint32_t> frequency_;         // Live rows per tag
+    std::vector<std::vector<TagId>> rowTags_;
+    std::vector<uint32_t> nodeIds_;
+    std::unordered_map<uint32_t, uint32_t> rowOf_;
+    size_t builtRows_ = 0;                    // Rows at the last build()
+    size_t removed_ = 0;                      // Empty rows left by remove()
+    size_t misplaced_ = 0;                    // Tags that crossed the dense threshold since build()
+
+    size_t planeCount() const { return (denseCount_ + 63) / 64; }
+    void reserveRows(size_t rows);
+    void setRow(size_t row, const std::vector<TagId>& tags);
+    void clearRow(size_t row);
+    void countTag(TagId tag, int delta);
+};
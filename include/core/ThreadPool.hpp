@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool for fork/join data-parallel loops.
+// The calling thread takes part as worker 0, so a pool of size N runs
+// N-1 background threads. One loop runs at a time; a parallelFor issued
+// from inside a worker runs serially instead of deadlocking.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t threads = 0); // 0 = hardware concurrency
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers_.size() + 1; }
+
+    // Split [0, n) into morsels pulled dynamically by up to `maxWorkers`
+    // workers (0 = all). fn(begin, end, worker) with worker < participants.
+    // Returns the number of participating workers; rethrows the first exception.
+    size_t parallelFor(size_t n, size_t morsel,
+                       const std::function<void(size_t, size_t, size_t)>& fn,
+                       size_t maxWorkers = 0);
+
+    // Process-wide pool for request-thread work (scans, on-demand graph kernels)
+    static ThreadPool& global();
+    static void setGlobalThreads(size_t threads); // Takes effect before first global() call
+    // Separate, half-size pool for background jobs, so a long PageRank or
+    // layout run never holds up a scan waiting on global()
+    static ThreadPool& background();
+    static void enterBackground(); // Marks the calling thread as a background job
+    // background() on job threads, global() otherwise: what graph kernels use
+    static ThreadPool& current();
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex runMutex_;       // Serializes parallelFor calls
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    bool stop_ = false;
+
+    // Current loop
+    uint64_t jobId_ = 0;
+    size_t participants_ = 0;
+    size_t pending_ = 0;
+    size_t n_ = 0;
+    size_t morsel_ = 1;
+    std::atomic<size_t> next_{0};
+    const std::function<void(size_t, size_t, size_t)>* fn_ = nullptr;
+    std::exception_ptr error_;
+
+    void workerLoop(size_t index);
+    void runMorsels(size_t worker);
+};
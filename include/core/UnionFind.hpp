@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Disjoint sets over element indices with union by size and path halving.
+// Elements past the current size are added on demand as singletons.
+class UnionFind
+{
+public:
+    void reset(size_t n);
+    void grow(size_t n); // Ensure at least n elements
+
+    size_t size() const { return parent_.size(); }
+
+    uint32_t find(uint32_t x);
+    bool unite(uint32_t a, uint32_t b); // false if already in one set
+    uint32_t setSize(uint32_t x) { return size_[find(x)]; }
+
+private:
+    std::vector<uint32_t> parent_;
+    std::vector<uint32_t> size_;   // Valid for roots
+};
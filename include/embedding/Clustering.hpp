@@ -21,7 +21,8 @@ public:
         const std::vector<std::tuple<int, int, float>>& pairs
     );
 
-    // Find connected components (clusters)
+    // Find connected components (clusters) with the parallel kernel; components
+    // are ordered by their first node in allNodeIds, members likewise
     static std::vector<std::vector<int>> findConnectedComponents(
         const std::unordered_map<int, std::vector<int>>& adjacencyList,
         const std::vector<int>& allNodeIds
@@ -33,10 +34,4 @@ public:
 
 private:
     static float threshold_;
-
-    // DFS helper for finding connected components
-    static void dfs(int node,
-                   const std::unordered_map<int, std::vector<int>>& adj,
-                   std::unordered_map<int, bool>& visited,
-                   std::vector<int>& component);
 };
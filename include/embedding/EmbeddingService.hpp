@@ -11,6 +11,7 @@ struct ClusteringResult {
     int nodesProcessed = 0;
     int embeddingsGenerated = 0;
     int linksCreated = 0;
+    int linksRemoved = 0;  // Embedding links no longer above the threshold
     int clustersFound = 0;
     std::vector<std::vector<int>> clusters;
 };
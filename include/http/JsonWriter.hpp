@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace whisperdb {
+namespace http {
+
+/**
+ * Incremental JSON encoder.
+ * Output goes into a caller-owned buffer that is handed to the sink whenever
+ * it grows past the flush threshold, so memory stays bounded regardless of
+ * document size. Without a sink the buffer simply accumulates the document.
+ * Commas are inserted automatically; keys must precede values inside objects.
+ */
+class JsonWriter {
+public:
+    using Sink = std::function<void(const char* data, size_t size)>;
+
+    static constexpr size_t DEFAULT_FLUSH_THRESHOLD = 64 * 1024;
+
+    explicit JsonWriter(std::string& buffer, Sink sink = nullptr,
+                        size_t flushThreshold = DEFAULT_FLUSH_THRESHOLD);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(std::string_view name);
+
+    void value(std::string_view s);
+    void value(const std::string& s) { value(std::string_view(s)); }
+    void value(const char* s) { value(std::string_view(s)); }
+    void value(int v) { value(static_cast<int64_t>(v)); }
+    void value(int64_t v);
+    void value(uint64_t v);
+    void value(double v);
+    void value(bool v);
+    void null();
+    void value(const nlohmann::json& j); // Embed a prebuilt fragment
+
+    // Append an already encoded JSON value
+    void raw(std::string_view encoded);
+
+    template <typename T>
+    void array(const std::vector<T>& items) {
+        beginArray();
+        for (const auto& item : items) value(item);
+        endArray();
+    }
+
+    // Hand buffered output to the sink (no-op without one)
+    void flush();
+    size_t bytesWritten() const { return written_ + buffer_.size(); }
+
+private:
+    std::string& buffer_;
+    Sink sink_;
+    size_t threshold_;
+    size_t written_ = 0;
+    std::vector<bool> first_; // Per open container: no element written yet
+    bool afterKey_ = false;
+
+    void separator();
+    void writeString(std::string_view s);
+    void maybeFlush() { if (sink_ && buffer_.size() >= threshold_) flush(); }
+};
+
+} // namespace http
+} // namespace whisperdb
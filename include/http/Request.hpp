@@ -3,7 +3,9 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <functional>
 #include "http/MultipartParser.hpp"
+#include "http/JsonWriter.hpp"
 #include "const/rest_enums.hpp"
 
 namespace whisperdb {
@@ -38,16 +40,23 @@ struct Request {
 
 /**
  * HTTP Response object
+ * Either `body` is sent as-is, or `stream` (when set) encodes the body
+ * incrementally and the server sends it with chunked transfer encoding.
  */
 struct Response {
     int status = 200;
     std::string contentType = "application/json";
     std::string body;
+    std::function<void(JsonWriter&)> stream = nullptr;
 
     static Response ok(const std::string& body) {
         return {200, "application/json", body};
     }
 
+    static Response streamed(std::function<void(JsonWriter&)> writer, int status = 200) {
+        return {status, "application/json", "", std::move(writer)};
+    }
+
     static Response created(const std::string& body) {
         return {201, "application/json", body};
     }
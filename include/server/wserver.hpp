@@ -12,6 +12,7 @@ class wServer
     boost::asio::io_context io_context_;
     boost::asio::ip::tcp::acceptor acceptor_;
     std::vector<endpoint> endpoints_;  // Changed to vector for pattern matching
+    std::string streamBuffer_;         // Reused across streamed responses
 
 public:
     wServer();
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "core/TagDictionary.hpp"
+
+// MinHash signatures with LSH banding over tag-id sets.
+// Two sets with Jaccard similarity s agree on one signature value with
+// probability s; splitting the signature into `bands` bands of `rows`
+// values makes them collide in some band with probability
+// 1 - (1 - s^rows)^bands, which is steep around (1/bands)^(1/rows).
+class MinHashLSH
+{
+public:
+    MinHashLSH(size_t bands, size_t rows, uint64_t seed = 0x9e3779b97f4a7c15ULL);
+
+    // Most selective banding (bands * rows <= numHashes) whose collision
+    // probability at `threshold` is still >= targetRecall
+    static MinHashLSH forThreshold(double threshold, size_t numHashes = 128, double targetRecall = 0.95);
+
+    size_t bands() const { return bands_; }
+    size_t rows() const { return rows_; }
+    size_t signatureSize() const { return bands_ * rows_; }
+
+    // Probability that two sets with Jaccard `similarity` become a candidate pair
+    double candidateProbability(double similarity) const;
+
+    // bands * rows minimum hash values of `tags` (must be non-empty)
+    void signature(const std::vector<TagId>& tags, uint32_t* out) const;
+
+    // Index pairs (i < j) into `sets` that collide in at least one band.
+    // Empty sets never become candidates. Signatures are computed on the shared pool.
+    std::vector<std::pair<uint32_t, uint32_t>> candidatePairs(const std::vector<const std::vector<TagId>*>& sets) const;
+
+private:
+    size_t bands_;
+    size_t rows_;
+    std::vector<uint64_t> seeds_; // One hash function per signature slot
+};
@@ -4,6 +4,14 @@
 #include <vector>
 #include <optional>
 
+// Size of the last chat request, for watching prompt growth
+struct TagPromptStats {
+    size_t bankTags = 0;     // Existing tags listed in the system prompt
+    size_t systemBytes = 0;
+    size_t userBytes = 0;
+    int promptTokens = -1;   // As reported by the API, -1 if unknown
+};
+
 class TagClient {
 public:
     TagClient(const std::string& apiKey,
@@ -21,11 +29,14 @@ public:
     // Set max new tags allowed per request
     void setMaxNewTags(int max) { maxNewTags_ = max; }
 
+    const TagPromptStats& lastPromptStats() const { return lastPrompt_; }
+
 private:
     std::string apiKey_;
     std::string baseUrl_;
     std::string model_ = "deepseek-chat";
     int maxNewTags_ = 3;
+    TagPromptStats lastPrompt_;
 
     // HTTP POST request using libcurl
     std::string httpPost(const std::string& url, const std::string& body,
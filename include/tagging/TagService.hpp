@@ -10,9 +10,26 @@ struct TagGenerationResult {
     std::vector<std::string> generatedTags;
     std::vector<std::string> newTagsAdded;
     std::vector<int> linkedNodeIds;
+    size_t bankSize = 0;       // Tag bank size before this request
+    TagPromptStats prompt;     // What was actually sent
     std::string error;
 };
 
+struct LinkAllResult {
+    int linksCreated = 0;
+    size_t nodesWithTags = 0;
+    size_t bands = 0;            // LSH banding used for candidate generation
+    size_t rows = 0;
+    size_t candidatePairs = 0;   // Pairs colliding in some band
+    size_t similarPairs = 0;     // Candidates with exact Jaccard >= threshold
+    double elapsedMs = 0;
+    // Optional exact all-pairs comparison
+    bool recallMeasured = false;
+    size_t exactPairs = 0;
+    double recall = 1.0;         // similarPairs / exactPairs
+    double exactMs = 0;
+};
+
 struct ClusterInfo {
     int id;
     std::vector<int> nodeIds;
@@ -27,7 +44,7 @@ public:
     TagGenerationResult generateTagsForNode(int nodeId, const std::string& storagePath);
 
     // Get the current tag bank
-    std::vector<std::string> getTagBank() const;
+    const std::vector<std::string>& getTagBank() const;
 
     // Find nodes that share any tags with the given node
     std::vector<int> findNodesWithSharedTags(int nodeId) const;
@@ -38,11 +55,14 @@ public:
     // Update LinkedNodes for a node based on Jaccard similarity
     int updateLinksForNode(int nodeId, float jaccardThreshold = 0.3f);
 
-    // Batch: update all node links based on Jaccard similarity
-    int updateAllTagBasedLinks(float jaccardThreshold = 0.3f);
+    // Batch: update all node links based on Jaccard similarity.
+    // Candidates come from MinHash/LSH and are verified exactly; all links are
+    // written in one batch. `measureRecall` also runs the exact all-pairs scan.
+    LinkAllResult updateAllTagBasedLinks(float jaccardThreshold = 0.3f, bool measureRecall = false);
 
-    // Get all connected components (clusters)
-    std::vector<ClusterInfo> getClusters() const;
+    // Get all connected components (clusters), largest first.
+    // Cached until links or tags change.
+    const std::vector<ClusterInfo>& getClusters() const;
 
     // Set model name
     void setModel(const std::string& model) { client_.setModel(model); }
@@ -51,9 +71,17 @@ private:
     GraphDB& db_;
     TagClient client_;
 
+    mutable std::vector<ClusterInfo> clusters_;
+    mutable std::pair<uint64_t, uint64_t> clustersGeneration_{UINT64_MAX, UINT64_MAX}; // (link, tag)
+
     // Build text content for tag generation
     std::string buildContentForTagging(const Node& node, const std::string& storagePath);
 
+    // The `limit` bank tags most relevant to `content`: word overlap with the
+    // text, co-occurrence with the node's tags and the lexical hits, then usage.
+    // Returns the whole bank when it already fits.
+    std::vector<std::string> selectPromptTags(const Node& node, const std::string& content, size_t limit) const;
+
     // Add bidirectional links between nodes
     void addBidirectionalLink(int nodeId1, int nodeId2);
 };
@@ -0,0 +1,334 @@
+#include "core/Bitmap.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    inline uint16_t highBits(uint32_t v) { return static_cast<uint16_t>(v >> 16); }
+    inline uint16_t lowBits(uint32_t v) { return static_cast<uint16_t>(v & 0xFFFF); }
+
+    // Plain word loops: the compiler vectorizes these and popcount maps to POPCNT
+    uint32_t popcountWords(const uint64_t* words, uint32_t n) {
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            count += static_cast<uint32_t>(__builtin_popcountll(words[i]));
+        }
+        return count;
+    }
+}
+
+void RoaringBitmap::Container::toBitset()
+{
+    bits.assign(BITSET_WORDS, 0);
+    for (uint16_t v : array) {
+        bits[v >> 6] |= (1ULL << (v & 63));
+    }
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::toArray()
+{
+    std::vector<uint16_t> values;
+    values.reserve(cardinality);
+    for (uint32_t w = 0; w < BITSET_WORDS; ++w) {
+        uint64_t word = bits[w];
+        while (word) {
+            values.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+            word &= word - 1;
+        }
+    }
+    array.swap(values);
+    bits.clear();
+    bits.shrink_to_fit();
+}
+
+RoaringBitmap::Container* RoaringBitmap::findContainer(uint16_t key)
+{
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+        [](const Container& c, uint16_t k) { return c.key < k; });
+    return (it != containers_.end() && it->key == key) ? &*it : nullptr;
+}
+
+const RoaringBitmap::Container* RoaringBitmap::findContainer(uint16_t key) const
+{
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+        [](const Container& c, uint16_t k) { return c.key < k; });
+    return (it != containers_.end() && it->key == key) ? &*it : nullptr;
+}
+
+void RoaringBitmap::add(uint32_t value)
+{
+    uint16_t key = highBits(value);
+    uint16_t low = lowBits(value);
+
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+        [](const Container& c, uint16_t k) { return c.key < k; });
+    if (it == containers_.end() || it->key != key) {
+        Container c;
+        c.key = key;
+        it = containers_.insert(it, std::move(c));
+    }
+
+    Container& c = *it;
+    if (c.isBitset()) {
+        uint64_t mask = 1ULL << (low & 63);
+        if (!(c.bits[low >> 6] & mask)) {
+            c.bits[low >> 6] |= mask;
+            c.cardinality++;
+        }
+        return;
+    }
+
+    auto pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+    if (pos != c.array.end() && *pos == low) {
+        return;
+    }
+    c.array.insert(pos, low);
+    c.cardinality++;
+    if (c.cardinality > ARRAY_MAX) {
+        c.toBitset();
+    }
+}
+
+void RoaringBitmap::remove(uint32_t value)
+{
+    uint16_t key = highBits(value);
+    uint16_t low = lowBits(value);
+
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+        [](const Container& c, uint16_t k) { return c.key < k; });
+    if (it == containers_.end() || it->key != key) {
+        return;
+    }
+
+    Container& c = *it;
+    if (c.isBitset()) {
+        uint64_t mask = 1ULL << (low & 63);
+        if (c.bits[low >> 6] & mask) {
+            c.bits[low >> 6] &= ~mask;
+            c.cardinality--;
+            if (c.cardinality <= ARRAY_MAX) {
+                c.toArray();
+            }
+        }
+    } else {
+        auto pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+        if (pos == c.array.end() || *pos != low) {
+            return;
+        }
+        c.array.erase(pos);
+        c.cardinality--;
+    }
+
+    if (c.cardinality == 0) {
+        containers_.erase(it);
+    }
+}
+
+bool RoaringBitmap::contains(uint32_t value) const
+{
+    const Container* c = findContainer(highBits(value));
+    if (!c) {
+        return false;
+    }
+    uint16_t low = lowBits(value);
+    if (c->isBitset()) {
+        return (c->bits[low >> 6] >> (low & 63)) & 1ULL;
+    }
+    return std::binary_search(c->array.begin(), c->array.end(), low);
+}
+
+uint64_t RoaringBitmap::cardinality() const
+{
+    uint64_t total = 0;
+    for (const auto& c : containers_) {
+        total += c.cardinality;
+    }
+    return total;
+}
+
+RoaringBitmap::Container RoaringBitmap::andContainers(const Container& a, const Container& b)
+{
+    Container out;
+    out.key = a.key;
+
+    if (a.isBitset() && b.isBitset()) {
+        out.bits.resize(BITSET_WORDS);
+        for (uint32_t i = 0; i < BITSET_WORDS; ++i) {
+            out.bits[i] = a.bits[i] & b.bits[i];
+        }
+        out.cardinality = popcountWords(out.bits.data(), BITSET_WORDS);
+        if (out.cardinality <= ARRAY_MAX) {
+            out.toArray();
+        }
+    } else if (a.isBitset() || b.isBitset()) {
+        const Container& bitset = a.isBitset() ? a : b;
+        const Container& array = a.isBitset() ? b : a;
+        out.array.reserve(array.array.size());
+        for (uint16_t v : array.array) {
+            if ((bitset.bits[v >> 6] >> (v & 63)) & 1ULL) {
+                out.array.push_back(v);
+            }
+        }
+        out.cardinality = static_cast<uint32_t>(out.array.size());
+    } else {
+        std::set_intersection(a.array.begin(), a.array.end(),
+                              b.array.begin(), b.array.end(),
+                              std::back_inserter(out.array));
+        out.cardinality = static_cast<uint32_t>(out.array.size());
+    }
+
+    return out;
+}
+
+RoaringBitmap::Container RoaringBitmap::orContainers(const Container& a, const Container& b)
+{
+    Container out;
+    out.key = a.key;
+
+    if (!a.isBitset() && !b.isBitset() && a.cardinality + b.cardinality <= ARRAY_MAX) {
+        std::set_union(a.array.begin(), a.array.end(),
+                       b.array.begin(), b.array.end(),
+                       std::back_inserter(out.array));
+        out.cardinality = static_cast<uint32_t>(out.array.size());
+        return out;
+    }
+
+    out.bits.assign(BITSET_WORDS, 0);
+    for (const Container* c : {&a, &b}) {
+        if (c->isBitset()) {
+            for (uint32_t i = 0; i < BITSET_WORDS; ++i) {
+                out.bits[i] |= c->bits[i];
+            }
+        } else {
+            for (uint16_t v : c->array) {
+                out.bits[v >> 6] |= (1ULL << (v & 63));
+            }
+        }
+    }
+    out.cardinality = popcountWords(out.bits.data(), BITSET_WORDS);
+    if (out.cardinality <= ARRAY_MAX) {
+        out.toArray();
+    }
+    return out;
+}
+
+uint32_t RoaringBitmap::andCardinality(const Container& a, const Container& b)
+{
+    if (a.isBitset() && b.isBitset()) {
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < BITSET_WORDS; ++i) {
+            count += static_cast<uint32_t>(__builtin_popcountll(a.bits[i] & b.bits[i]));
+        }
+        return count;
+    }
+
+    if (a.isBitset() || b.isBitset()) {
+        const Container& bitset = a.isBitset() ? a : b;
+        const Container& array = a.isBitset() ? b : a;
+        uint32_t count = 0;
+        for (uint16_t v : array.array) {
+            count += static_cast<uint32_t>((bitset.bits[v >> 6] >> (v & 63)) & 1ULL);
+        }
+        return count;
+    }
+
+    uint32_t count = 0;
+    auto i = a.array.begin();
+    auto j = b.array.begin();
+    while (i != a.array.end() && j != b.array.end()) {
+        if (*i < *j) ++i;
+        else if (*j < *i) ++j;
+        else { ++count; ++i; ++j; }
+    }
+    return count;
+}
+
+RoaringBitmap RoaringBitmap::operator&(const RoaringBitmap& other) const
+{
+    RoaringBitmap result;
+    auto i = containers_.begin();
+    auto j = other.containers_.begin();
+
+    while (i != containers_.end() && j != other.containers_.end()) {
+        if (i->key < j->key) {
+            ++i;
+        } else if (j->key < i->key) {
+            ++j;
+        } else {
+            Container c = andContainers(*i, *j);
+            if (c.cardinality > 0) {
+                result.containers_.push_back(std::move(c));
+            }
+            ++i;
+            ++j;
+        }
+    }
+
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::operator|(const RoaringBitmap& other) const
+{
+    RoaringBitmap result;
+    auto i = containers_.begin();
+    auto j = other.containers_.begin();
+
+    while (i != containers_.end() || j != other.containers_.end()) {
+        if (j == other.containers_.end() || (i != containers_.end() && i->key < j->key)) {
+            result.containers_.push_back(*i++);
+        } else if (i == containers_.end() || j->key < i->key) {
+            result.containers_.push_back(*j++);
+        } else {
+            result.containers_.push_back(orContainers(*i, *j));
+            ++i;
+            ++j;
+        }
+    }
+
+    return result;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other)
+{
+    *this = *this & other;
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other)
+{
+    *this = *this | other;
+    return *this;
+}
+
+uint64_t RoaringBitmap::andCardinality(const RoaringBitmap& other) const
+{
+    uint64_t count = 0;
+    auto i = containers_.begin();
+    auto j = other.containers_.begin();
+
+    while (i != containers_.end() && j != other.containers_.end()) {
+        if (i->key < j->key) {
+            ++i;
+        } else if (j->key < i->key) {
+            ++j;
+        } else {
+            count += andCardinality(*i, *j);
+            ++i;
+            ++j;
+        }
+    }
+
+    return count;
+}
+
+std::vector<uint32_t> RoaringBitmap::toVector() const
+{
+    std::vector<uint32_t> values;
+    values.reserve(static_cast<size_t>(cardinality()));
+    forEach([&values](uint32_t v) {
+        values.push_back(v);
+        return true;
+    });
+    return values;
+}
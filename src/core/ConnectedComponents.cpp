@@ -0,0 +1,128 @@
+#include "core/ConnectedComponents.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+namespace {
+    const size_t VERTEX_MORSEL = 4096;
+    const size_t EDGE_MORSEL = 16384;
+    const uint32_t NEIGHBOR_ROUNDS = 2; // Afforest sampling rounds
+    const size_t COMPONENT_SAMPLE = 1024;
+
+    class Parents {
+    public:
+        explicit Parents(size_t n) : p_(new std::atomic<uint32_t>[n]), n_(n) {
+            ThreadPool::current().parallelFor(n, VERTEX_MORSEL, [this](size_t begin, size_t end, size_t) {
+                for (size_t v = begin; v < end; ++v) {
+                    p_[v].store(static_cast<uint32_t>(v), std::memory_order_relaxed);
+                }
+            });
+        }
+
+        // Root with path halving
+        uint32_t find(uint32_t x) {
+            while (true) {
+                uint32_t parent = p_[x].load(std::memory_order_relaxed);
+                if (parent == x) return x;
+                uint32_t grand = p_[parent].load(std::memory_order_relaxed);
+                if (grand != parent) {
+                    p_[x].compare_exchange_weak(parent, grand, std::memory_order_relaxed);
+                }
+                x = grand;
+            }
+        }
+
+        // Hook the larger root under the smaller; retry if a root moved
+        void link(uint32_t a, uint32_t b) {
+            while (true) {
+                a = find(a);
+                b = find(b);
+                if (a == b) return;
+                if (a < b) std::swap(a, b);
+                uint32_t expected = a;
+                if (p_[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) return;
+            }
+        }
+
+        // Point every vertex straight at its root
+        void compress() {
+            ThreadPool::current().parallelFor(n_, VERTEX_MORSEL, [this](size_t begin, size_t end, size_t) {
+                for (size_t v = begin; v < end; ++v) {
+                    p_[v].store(find(static_cast<uint32_t>(v)), std::memory_order_relaxed);
+                }
+            });
+        }
+
+        uint32_t label(uint32_t v) const { return p_[v].load(std::memory_order_relaxed); }
+
+        std::vector<uint32_t> labels() const {
+            std::vector<uint32_t> out(n_);
+            for (size_t v = 0; v < n_; ++v) out[v] = label(static_cast<uint32_t>(v));
+            return out;
+        }
+
+    private:
+        std::unique_ptr<std::atomic<uint32_t>[]> p_;
+        size_t n_;
+    };
+}
+
+std::vector<uint32_t> ConnectedComponents::fromEdges(size_t vertexCount, const std::vector<std::pair<uint32_t, uint32_t>>& edges)
+{
+    Parents parents(vertexCount);
+    ThreadPool::current().parallelFor(edges.size(), EDGE_MORSEL, [&](size_t begin, size_t end, size_t) {
+        for (size_t e = begin; e < end; ++e) {
+            parents.link(edges[e].first, edges[e].second);
+        }
+    });
+    parents.compress();
+    return parents.labels();
+}
+
+std::vector<uint32_t> ConnectedComponents::fromGraph(const CsrGraph& graph)
+{
+    size_t n = graph.vertexCount();
+    Parents parents(n);
+    if (n == 0) {
+        return {};
+    }
+
+    // Sampling: the first few neighbors already join most of a big component
+    for (uint32_t round = 0; round < NEIGHBOR_ROUNDS; ++round) {
+        ThreadPool::current().parallelFor(n, VERTEX_MORSEL, [&](size_t begin, size_t end, size_t) {
+            for (size_t v = begin; v < end; ++v) {
+                auto neighbors = graph.neighbors(static_cast<uint32_t>(v));
+                if (neighbors.size() > round) {
+                    parents.link(static_cast<uint32_t>(v), neighbors.begin()[round]);
+                }
+            }
+        });
+        parents.compress();
+    }
+
+    // Most frequent label among evenly spaced vertices
+    std::unordered_map<uint32_t, size_t> counts;
+    size_t step = std::max<size_t>(n / COMPONENT_SAMPLE, 1);
+    for (size_t v = 0; v < n; v += step) {
+        counts[parents.label(static_cast<uint32_t>(v))]++;
+    }
+    uint32_t dominant = std::max_element(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+        return a.second < b.second;
+    })->first;
+
+    // Remaining edges; a vertex already in the dominant component can be
+    // skipped because each of its edges is also seen from the other end
+    ThreadPool::current().parallelFor(n, VERTEX_MORSEL, [&](size_t begin, size_t end, size_t) {
+        for (size_t v = begin; v < end; ++v) {
+            if (parents.find(static_cast<uint32_t>(v)) == dominant) continue;
+            auto neighbors = graph.neighbors(static_cast<uint32_t>(v));
+            for (size_t i = NEIGHBOR_ROUNDS; i < neighbors.size(); ++i) {
+                parents.link(static_cast<uint32_t>(v), neighbors.begin()[i]);
+            }
+        }
+    });
+    parents.compress();
+    return parents.labels();
+}
@@ -0,0 +1,124 @@
+#include "core/CsrGraph.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+
+namespace {
+    const size_t ROW_MORSEL = 1024;
+}
+
+void CsrGraph::build(std::vector<uint32_t> ids, const std::function<const std::vector<int>&(size_t)>& links,
+                     const std::function<EdgeInfo(uint32_t, uint32_t)>& info)
+{
+    ids_ = std::move(ids);
+    size_t n = ids_.size();
+
+    // Node ids are mostly dense, so a direct table usually beats binary search
+    std::vector<int32_t> dense;
+    if (n > 0 && ids_.back() <= 4 * n + 1024) {
+        dense.assign(static_cast<size_t>(ids_.back()) + 1, -1);
+        for (size_t v = 0; v < n; ++v) {
+            dense[ids_[v]] = static_cast<int32_t>(v);
+        }
+    }
+    auto resolve = [&](int link) -> int {
+        if (link < 0) return -1;
+        if (!dense.empty()) {
+            return static_cast<size_t>(link) < dense.size() ? dense[static_cast<size_t>(link)] : -1;
+        }
+        return vertexOf(static_cast<uint32_t>(link));
+    };
+
+    // Count both directions of every link, then scatter into rows
+    std::vector<uint64_t> start(n + 1, 0);
+    for (size_t v = 0; v < n; ++v) {
+        for (int link : links(v)) {
+            int u = resolve(link);
+            if (u < 0 || static_cast<size_t>(u) == v) continue;
+            start[v + 1]++;
+            start[static_cast<size_t>(u) + 1]++;
+        }
+    }
+    for (size_t v = 0; v < n; ++v) {
+        start[v + 1] += start[v];
+    }
+
+    std::vector<uint64_t> cursor(start.begin(), start.end() - 1);
+    std::vector<uint32_t> scattered(start[n]);
+    for (size_t v = 0; v < n; ++v) {
+        for (int link : links(v)) {
+            int u = resolve(link);
+            if (u < 0 || static_cast<size_t>(u) == v) continue;
+            scattered[cursor[v]++] = static_cast<uint32_t>(u);
+            scattered[cursor[static_cast<size_t>(u)]++] = static_cast<uint32_t>(v);
+        }
+    }
+
+    // Sort and dedupe each row (A->B and B->A both usually exist in LinkedNodes)
+    std::vector<uint64_t> unique(n, 0);
+    ThreadPool::current().parallelFor(n, ROW_MORSEL, [&](size_t begin, size_t end, size_t) {
+        for (size_t v = begin; v < end; ++v) {
+            auto first = scattered.begin() + static_cast<std::ptrdiff_t>(start[v]);
+            auto last = scattered.begin() + static_cast<std::ptrdiff_t>(start[v + 1]);
+            std::sort(first, last);
+            unique[v] = static_cast<uint64_t>(std::unique(first, last) - first);
+        }
+    });
+
+    offsets_.assign(n + 1, 0);
+    for (size_t v = 0; v < n; ++v) {
+        offsets_[v + 1] = offsets_[v] + unique[v];
+    }
+    if (offsets_[n] == scattered.size()) {
+        targets_ = std::move(scattered); // No duplicates: rows already in place
+    } else {
+        targets_.resize(offsets_[n]);
+        for (size_t v = 0; v < n; ++v) {
+            std::copy_n(scattered.begin() + static_cast<std::ptrdiff_t>(start[v]), unique[v],
+                        targets_.begin() + static_cast<std::ptrdiff_t>(offsets_[v]));
+        }
+    }
+
+    weights_.clear();
+    types_.clear();
+    if (!info) {
+        return;
+    }
+    weights_.resize(targets_.size());
+    types_.resize(targets_.size());
+    ThreadPool::current().parallelFor(n, ROW_MORSEL, [&](size_t begin, size_t end, size_t) {
+        for (size_t v = begin; v < end; ++v) {
+            for (uint64_t e = offsets_[v]; e < offsets_[v + 1]; ++e) {
+                EdgeInfo edge = info(ids_[v], ids_[targets_[e]]);
+                weights_[e] = edge.weight;
+                types_[e] = edge.types;
+            }
+        }
+    });
+}
+
+void CsrGraph::clear()
+{
+    ids_.clear();
+    offsets_.assign(1, 0);
+    targets_.clear();
+    weights_.clear();
+    types_.clear();
+}
+
+uint32_t CsrGraph::degree(uint32_t vertex, const EdgeFilter& filter) const
+{
+    if (filter.all()) {
+        return degree(vertex);
+    }
+    uint32_t count = 0;
+    for (uint64_t e = offsets_[vertex]; e < offsets_[vertex + 1]; ++e) {
+        count += filter.accepts(weight(e), edgeTypes(e)) ? 1 : 0;
+    }
+    return count;
+}
+
+int CsrGraph::vertexOf(uint32_t nodeId) const
+{
+    auto it = std::lower_bound(ids_.begin(), ids_.end(), nodeId);
+    return it != ids_.end() && *it == nodeId ? static_cast<int>(it - ids_.begin()) : -1;
+}
@@ -0,0 +1,212 @@
+#include "core/EdgeStore.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    const char EDGE_FILE_MAGIC[4] = {'W', 'D', 'B', 'E'};
+    const uint32_t EDGE_FILE_VERSION = 1;
+
+    template <typename T>
+    void writeColumn(std::ofstream& out, const std::vector<T>& column) {
+        out.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size() * sizeof(T)));
+    }
+
+    template <typename T>
+    bool readColumn(std::ifstream& in, std::vector<T>& column, size_t count) {
+        column.resize(count);
+        in.read(reinterpret_cast<char*>(column.data()), static_cast<std::streamsize>(count * sizeof(T)));
+        return static_cast<bool>(in);
+    }
+}
+
+bool EdgeStore::upsert(uint32_t a, uint32_t b, EdgeType type, float weight, uint32_t timestamp)
+{
+    auto [it, inserted] = slots_.emplace(key(a, b), static_cast<uint32_t>(keys_.size()));
+    if (inserted) {
+        keys_.push_back(it->first);
+        weights_.push_back(weight);
+        timestamps_.push_back(timestamp);
+        types_.push_back(type);
+        return true;
+    }
+
+    uint32_t slot = it->second;
+    float merged = types_[slot] == type ? weight : std::max(weights_[slot], weight);
+    if (merged == weights_[slot] && (types_[slot] & type)) {
+        return false;
+    }
+    weights_[slot] = merged;
+    timestamps_[slot] = timestamp;
+    types_[slot] |= type;
+    return true;
+}
+
+bool EdgeStore::removeType(uint32_t a, uint32_t b, EdgeType type)
+{
+    auto it = slots_.find(key(a, b));
+    if (it == slots_.end()) {
+        return false;
+    }
+    uint32_t slot = it->second;
+    types_[slot] &= static_cast<uint8_t>(~type);
+    if (types_[slot] != 0) {
+        return false;
+    }
+    removeSlot(slot);
+    return true;
+}
+
+bool EdgeStore::erase(uint32_t a, uint32_t b)
+{
+    auto it = slots_.find(key(a, b));
+    if (it == slots_.end()) {
+        return false;
+    }
+    removeSlot(it->second);
+    return true;
+}
+
+void EdgeStore::removeSlot(uint32_t slot)
+{
+    uint32_t last = static_cast<uint32_t>(keys_.size() - 1);
+    slots_.erase(keys_[slot]);
+    if (slot != last) {
+        keys_[slot] = keys_[last];
+        weights_[slot] = weights_[last];
+        timestamps_[slot] = timestamps_[last];
+        types_[slot] = types_[last];
+        slots_[keys_[slot]] = slot;
+    }
+    keys_.pop_back();
+    weights_.pop_back();
+    timestamps_.pop_back();
+    types_.pop_back();
+}
+
+void EdgeStore::clear()
+{
+    slots_.clear();
+    keys_.clear();
+    weights_.clear();
+    timestamps_.clear();
+    types_.clear();
+}
+
+bool EdgeStore::find(uint32_t a, uint32_t b, EdgeInfo& info) const
+{
+    auto it = slots_.find(key(a, b));
+    if (it == slots_.end()) {
+        return false;
+    }
+    info = {weights_[it->second], timestamps_[it->second], types_[it->second]};
+    return true;
+}
+
+EdgeInfo EdgeStore::get(uint32_t a, uint32_t b) const
+{
+    EdgeInfo info;
+    find(a, b, info);
+    return info;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> EdgeStore::withType(EdgeType type) const
+{
+    std::vector<std::pair<uint32_t, uint32_t>> result;
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        if (types_[i] & type) {
+            result.emplace_back(static_cast<uint32_t>(keys_[i] >> 32), static_cast<uint32_t>(keys_[i]));
+        }
+    }
+    return result;
+}
+
+bool EdgeStore::save(const std::string& path) const
+{
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        uint64_t count = keys_.size();
+        out.write(EDGE_FILE_MAGIC, sizeof(EDGE_FILE_MAGIC));
+        out.write(reinterpret_cast<const char*>(&EDGE_FILE_VERSION), sizeof(EDGE_FILE_VERSION));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        writeColumn(out, keys_);
+        writeColumn(out, weights_);
+        writeColumn(out, timestamps_);
+        writeColumn(out, types_);
+        if (!out) {
+            return false;
+        }
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+bool EdgeStore::load(const std::string& path)
+{
+    clear();
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t count = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || std::memcmp(magic, EDGE_FILE_MAGIC, sizeof(magic)) != 0 || version != EDGE_FILE_VERSION) {
+        return false;
+    }
+
+    // Reject a count the file cannot hold before allocating for it
+    const size_t recordBytes = sizeof(uint64_t) + sizeof(float) + sizeof(uint32_t) + sizeof(uint8_t);
+    std::streamoff header = in.tellg();
+    in.seekg(0, std::ios::end);
+    uint64_t available = static_cast<uint64_t>(in.tellg() - header);
+    in.seekg(header);
+    if (count > available / recordBytes) {
+        return false;
+    }
+
+    if (!readColumn(in, keys_, count) || !readColumn(in, weights_, count) ||
+        !readColumn(in, timestamps_, count) || !readColumn(in, types_, count)) {
+        clear();
+        return false;
+    }
+    slots_.reserve(count);
+    for (uint32_t i = 0; i < keys_.size(); ++i) {
+        slots_.emplace(keys_[i], i);
+    }
+    return true;
+}
+
+uint8_t EdgeStore::parseTypes(const std::string& list)
+{
+    uint8_t types = 0;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string name = list.substr(start, end - start);
+        if (name == "manual") types |= EDGE_MANUAL;
+        else if (name == "tag") types |= EDGE_TAG;
+        else if (name == "embedding") types |= EDGE_EMBEDDING;
+        else if (!name.empty()) return 0;
+        start = end + 1;
+    }
+    return types;
+}
+
+std::vector<std::string> EdgeStore::typeNames(uint8_t types)
+{
+    std::vector<std::string> names;
+    if (types & EDGE_MANUAL) names.push_back("manual");
+    if (types & EDGE_TAG) names.push_back("tag");
+    if (types & EDGE_EMBEDDING) names.push_back("embedding");
+    return names;
+}
@@ -1,5 +1,9 @@
 #include "core/GNode.hpp"
+#include "http/JsonWriter.hpp"
 #include <climits>
+#include <cctype>
+#include <sstream>
+#include <algorithm>
 
 
 Node::Node(const nlohmann::json& j, int id){
@@ -27,6 +31,7 @@ Node::Node(const nlohmann::json& j, int id){
     description = j.value("description", "");
     author = j.value("author", "");
     date = j.value("date", "");
+    dateEpoch = parseDate(date).value_or(NO_DATE);
     
     // Handle tags as either array or string (same as in the other constructor)
     if (j.contains("tags")) {
@@ -56,6 +61,10 @@ Node::Node(const nlohmann::json& j, int id){
     if (j.contains("embedding") && j["embedding"].is_array()) {
         embedding = j["embedding"].get<std::vector<float>>();
     }
+
+    if (j.contains("community") && j["community"].is_number_integer()) {
+        community = j["community"].get<int>();
+    }
 }
 
 Node::Node(const nlohmann::json& j){
@@ -83,6 +92,7 @@ Node::Node(const nlohmann::json& j){
     description = j.value("description", "");
     author = j.value("author", "");
     date = j.value("date", "");
+    dateEpoch = parseDate(date).value_or(NO_DATE);
     
     // Handle tags as either array or string
     if (j.contains("tags")) {
@@ -112,30 +122,124 @@ Node::Node(const nlohmann::json& j){
     if (j.contains("embedding") && j["embedding"].is_array()) {
         embedding = j["embedding"].get<std::vector<float>>();
     }
+
+    if (j.contains("community") && j["community"].is_number_integer()) {
+        community = j["community"].get<int>();
+    }
 }
 
 
 nlohmann::json Node::to_json() const {
-    nlohmann::json j = {
-        {"id", id},
-        {"title", title},
-        {"course", course},
-        {"subject", subject},
-        {"description", description},
-        {"author", author},
-        {"date", date},
-        {"tags", tags},
-        {"storage_path", storage_path},
-        {"LinkedNodes", LinkedNodes}
-    };
+    return to_json(ALL_FIELDS);
+}
 
-    if (!embedding.empty()) {
+nlohmann::json Node::to_json(uint32_t fields) const {
+    nlohmann::json j = nlohmann::json::object();
+
+    if (fields & FIELD_ID) j["id"] = id;
+    if (fields & FIELD_TITLE) j["title"] = title;
+    if (fields & FIELD_COURSE) j["course"] = course;
+    if (fields & FIELD_SUBJECT) j["subject"] = subject;
+    if (fields & FIELD_DESCRIPTION) j["description"] = description;
+    if (fields & FIELD_AUTHOR) j["author"] = author;
+    if ((fields & FIELD_COMMUNITY) && community >= 0) j["community"] = community;
+    if (fields & FIELD_DATE) j["date"] = date;
+    if (fields & FIELD_TAGS) j["tags"] = tags;
+    if (fields & FIELD_STORAGE_PATH) j["storage_path"] = storage_path;
+    if (fields & FIELD_LINKED_NODES) j["LinkedNodes"] = LinkedNodes;
+
+    if ((fields & FIELD_EMBEDDING) && !embedding.empty()) {
         j["embedding"] = embedding;
     }
 
     return j;
 }
 
+void Node::writeJson(whisperdb::http::JsonWriter& out, uint32_t fields) const {
+    // Keys in the same (sorted) order nlohmann uses, so both paths emit identical bytes
+    out.beginObject();
+    if (fields & FIELD_LINKED_NODES) { out.key("LinkedNodes"); out.array(LinkedNodes); }
+    if (fields & FIELD_AUTHOR) { out.key("author"); out.value(author); }
+    if ((fields & FIELD_COMMUNITY) && community >= 0) { out.key("community"); out.value(community); }
+    if (fields & FIELD_COURSE) { out.key("course"); out.value(course); }
+    if (fields & FIELD_DATE) { out.key("date"); out.value(date); }
+    if (fields & FIELD_DESCRIPTION) { out.key("description"); out.value(description); }
+    if ((fields & FIELD_EMBEDDING) && !embedding.empty()) {
+        out.key("embedding");
+        out.beginArray();
+        for (float v : embedding) out.value(static_cast<double>(v));
+        out.endArray();
+    }
+    if (fields & FIELD_ID) { out.key("id"); out.value(id); }
+    if (fields & FIELD_STORAGE_PATH) { out.key("storage_path"); out.value(storage_path); }
+    if (fields & FIELD_SUBJECT) { out.key("subject"); out.value(subject); }
+    if (fields & FIELD_TAGS) { out.key("tags"); out.array(tags); }
+    if (fields & FIELD_TITLE) { out.key("title"); out.value(title); }
+    out.endObject();
+}
+
+const std::string& Node::jsonFragment(uint32_t fields) const {
+    for (const auto& fragment : jsonFragments_) {
+        if (fragment.fields == fields) return fragment.bytes;
+    }
+
+    // Reserve up front so filling a new slot never moves the others; a full
+    // cache overwrites the oldest slot, ending references into it
+    JsonFragment* slot;
+    if (jsonFragments_.size() < MAX_JSON_FRAGMENTS) {
+        jsonFragments_.reserve(MAX_JSON_FRAGMENTS);
+        slot = &jsonFragments_.emplace_back();
+    } else {
+        slot = &jsonFragments_[nextFragmentSlot_++ % MAX_JSON_FRAGMENTS];
+    }
+
+    slot->fields = fields;
+    whisperdb::http::JsonWriter out(slot->bytes);
+    writeJson(out, fields);
+    slot->bytes.shrink_to_fit();
+    return slot->bytes;
+}
+
+std::optional<uint32_t> Node::parseFields(const std::string& list) {
+    static const std::vector<std::pair<std::string, uint32_t>> names = {
+        {"id", FIELD_ID},
+        {"title", FIELD_TITLE},
+        {"course", FIELD_COURSE},
+        {"subject", FIELD_SUBJECT},
+        {"description", FIELD_DESCRIPTION},
+        {"author", FIELD_AUTHOR},
+        {"date", FIELD_DATE},
+        {"tags", FIELD_TAGS},
+        {"storage_path", FIELD_STORAGE_PATH},
+        {"LinkedNodes", FIELD_LINKED_NODES},
+        {"embedding", FIELD_EMBEDDING},
+        {"community", FIELD_COMMUNITY}
+    };
+
+    uint32_t fields = 0;
+    std::istringstream iss(list);
+    std::string name;
+    while (std::getline(iss, name, ',')) {
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+        if (name.empty()) continue;
+
+        if (name == "*" || name == "all") {
+            fields |= ALL_FIELDS;
+            continue;
+        }
+
+        auto it = std::find_if(names.begin(), names.end(),
+            [&name](const auto& entry) { return entry.first == name; });
+        if (it == names.end()) {
+            return std::nullopt;
+        }
+        fields |= it->second;
+    }
+
+    return fields;
+}
+
 
 std::string Node::to_str() {
     return "Node ID: " + std::to_string(id) + "\n" +
@@ -146,6 +250,8 @@ std::string Node::to_str() {
 }
 
 void Node::updateFromJson(const nlohmann::json& j) {
+    invalidateJson();
+
     // Update only fields that are present in JSON
     if (j.contains("title") && j["title"].is_string()) {
         title = j["title"].get<std::string>();
@@ -175,9 +281,11 @@ void Node::updateFromJson(const nlohmann::json& j) {
 
     if (j.contains("date") && j["date"].is_string()) {
         date = j["date"].get<std::string>();
+        dateEpoch = parseDate(date).value_or(NO_DATE);
     }
 
     if (j.contains("tags")) {
+        tagIds.clear();
         if (j["tags"].is_array()) {
             tags = j["tags"].get<std::vector<std::string>>();
         } else if (j["tags"].is_string()) {
@@ -202,4 +310,59 @@ void Node::updateFromJson(const nlohmann::json& j) {
     if (j.contains("embedding") && j["embedding"].is_array()) {
         embedding = j["embedding"].get<std::vector<float>>();
     }
-}
\ No newline at end of file
+}
+
+std::optional<int64_t> Node::parseDate(const std::string& s, bool* wholeDay) {
+    // Fixed-width fields only: no signs, padding or trailing characters
+    auto number = [&s](size_t pos, size_t width, int& out) {
+        if (pos + width > s.size()) return false;
+        out = 0;
+        for (size_t i = pos; i < pos + width; ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(s[i]))) return false;
+            out = out * 10 + (s[i] - '0');
+        }
+        return true;
+    };
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    if (!number(0, 4, year) || s[4] != '-' || !number(5, 2, month) || s[7] != '-' || !number(8, 2, day)) {
+        return std::nullopt;
+    }
+    size_t end = 10;
+    if (s.size() > end) {
+        // A time needs at least hours and minutes: "2024-05-01T10" is rejected
+        if ((s[10] != ' ' && s[10] != 'T') || !number(11, 2, hour) || s.size() < 14 || s[13] != ':' ||
+            !number(14, 2, minute)) {
+            return std::nullopt;
+        }
+        end = 16;
+        if (s.size() > end && (s[16] != ':' || !number(17, 2, second))) {
+            return std::nullopt;
+        }
+        end = s.size() > 16 ? 19 : 16;
+    }
+    if (end != s.size()) {
+        return std::nullopt;
+    }
+
+    static const int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month < 1 || month > 12 || hour > 23 || minute > 59 || second > 59) {
+        return std::nullopt;
+    }
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (day < 1 || day > daysInMonth[month - 1] + (month == 2 && leap ? 1 : 0)) {
+        return std::nullopt; // 2024-02-31 is not March 2
+    }
+    if (wholeDay) {
+        *wholeDay = end == 10;
+    }
+
+    // Days from civil date (proleptic Gregorian calendar)
+    int64_t y = year - (month <= 2 ? 1 : 0);
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = era * 146097 + doe - 719468;
+
+    return days * 86400 + hour * 3600 + minute * 60 + second;
+}
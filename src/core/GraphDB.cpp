@@ -1,19 +1,113 @@
 #include "core/GraphDB.hpp"
 #include "server/FileStorage.hpp"
+#include "core/ThreadPool.hpp"
+#include "core/ConnectedComponents.hpp"
+#include "core/PageRank.hpp"
+#include "core/Louvain.hpp"
+#include "core/LinkPrediction.hpp"
+#include "core/GraphLayout.hpp"
 #include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <limits>
+#include <chrono>
+#include <ctime>
 #include "config.hpp"
 #include <iostream>
 
+namespace {
+    // Build a canonical cache key so equivalent queries share an entry
+    std::string queryKey(
+        const std::string& op,
+        const std::unordered_map<std::string, std::string>& filters,
+        const std::string& sortBy,
+        const std::string& order,
+        int limit,
+        int offset,
+        uint32_t fields,
+        uint64_t rankVersion = 0
+    ) {
+        std::vector<std::pair<std::string, std::string>> sorted(filters.begin(), filters.end());
+        std::sort(sorted.begin(), sorted.end());
+
+        static const std::vector<std::string> sortFields = {"id", "title", "author", "subject", "course", "date", "rank"};
+        bool knownSort = std::find(sortFields.begin(), sortFields.end(), sortBy) != sortFields.end();
+
+        std::string key = op;
+        for (const auto& [k, v] : sorted) {
+            key += '\x1f' + k + '=' + v;
+        }
+        key += "\x1esort=" + (knownSort ? sortBy : std::string("id"));
+        key += "\x1eorder=" + std::string(order == "asc" ? "asc" : "desc");
+        key += "\x1elimit=" + std::to_string(limit > 0 ? limit : -1);
+        key += "\x1eoffset=" + std::to_string(offset > 0 ? offset : 0);
+        key += "\x1e" "fields=" + std::to_string(fields);
+        if (sortBy == "rank") {
+            key += "\x1e" "rank=" + std::to_string(rankVersion); // A new rank column reorders results
+        }
+        return key;
+    }
+
+    // Ordering used by list queries; unknown fields fall back to id.
+    // `ranks` is the PageRank column by node id (rank sort only).
+    bool nodeLess(const Node* a, const Node* b, const std::string& sortBy, bool ascending,
+                  const std::vector<float>* ranks = nullptr) {
+        if (!ascending) std::swap(a, b);
+
+        // Ties are broken by id so pages stay stable across requests
+        if (sortBy == "title") {
+            if (a->getTitle() != b->getTitle()) return a->getTitle() < b->getTitle();
+        } else if (sortBy == "author") {
+            if (a->getAuthor() != b->getAuthor()) return a->getAuthor() < b->getAuthor();
+        } else if (sortBy == "subject") {
+            if (a->getSubject() != b->getSubject()) return a->getSubject() < b->getSubject();
+        } else if (sortBy == "course") {
+            if (a->getCourse() != b->getCourse()) return a->getCourse() < b->getCourse();
+        } else if (sortBy == "date") {
+            if (a->getDateEpoch() != b->getDateEpoch()) return a->getDateEpoch() < b->getDateEpoch();
+        } else if (sortBy == "rank" && ranks) {
+            auto rank = [ranks](const Node* n) {
+                size_t id = static_cast<size_t>(n->getId());
+                return id < ranks->size() ? (*ranks)[id] : 0.0f;
+            };
+            if (rank(a) != rank(b)) return rank(a) < rank(b);
+        }
+        return a->getId() < b->getId();
+    }
+
+    // Collect ids into a bitmap; sorting first keeps container appends cheap
+    RoaringBitmap bitmapFromIds(std::vector<uint32_t>& ids) {
+        std::sort(ids.begin(), ids.end());
+        RoaringBitmap bitmap;
+        for (uint32_t id : ids) {
+            bitmap.add(id);
+        }
+        return bitmap;
+    }
+}
 
-GraphDB::GraphDB() : size(0) {
+
+GraphDB::GraphDB()
+    : size(0), queryCache_(QUERY_CACHE_CAPACITY, QUERY_CACHE_MAX_BYTES),
+      scanThreads_(SCAN_THREADS), parallelScanThreshold_(PARALLEL_SCAN_THRESHOLD) {
     fileStorage = std::make_unique<FileStorage>("storage");
     this->initGraphDB();
 }
 
 GraphDB::~GraphDB() {
+    if (rankThread_.joinable()) {
+        rankThread_.join();
+    }
+    if (linkCheckThread_.joinable()) {
+        linkCheckThread_.join();
+    }
+    if (layoutThread_.joinable()) {
+        layoutThread_.join();
+    }
+    if (communityJob_) {
+        installCommunityJob(); // Labels are persisted: keep a finished run
+    }
     saveToJson();
     // Clean up node pointers
     for (auto& pair : nodes) {
@@ -23,7 +117,10 @@ GraphDB::~GraphDB() {
 
 void GraphDB::initGraphDB()
 {
-    if(std::filesystem::exists(DB_FILE_PATH)) loadFromJson();
+    if(std::filesystem::exists(DB_FILE_PATH)) {
+        loadFromJson();
+        startLinkCheck(); // Files written before links were kept symmetric
+    }
     else createJson();
 }
 
@@ -37,6 +134,31 @@ Node GraphDB::find(const std::string& id) const
     }
 }
 
+nlohmann::json GraphDB::getNodeJson(const std::string& id, uint32_t fields) const
+{
+    auto it = nodes.find(id);
+    if (it == nodes.end()) {
+        throw std::runtime_error("Node not found");
+    }
+    return it->second->to_json(fields);
+}
+
+std::vector<std::pair<int, const std::vector<float>*>> GraphDB::getEmbeddings(std::vector<int>* missing) const
+{
+    // Not through findNodes: a full ALL_FIELDS page would serialize and cache every vector
+    std::vector<std::pair<int, const std::vector<float>*>> embeddings;
+    allNodes_.forEach([&](uint32_t id) {
+        const Node* node = nodeById(id);
+        if (node->hasEmbedding()) {
+            embeddings.emplace_back(node->getId(), &node->getEmbedding());
+        } else if (missing) {
+            missing->push_back(node->getId());
+        }
+        return true;
+    });
+    return embeddings;
+}
+
 bool GraphDB::exists(const std::string& id) const
 {
     return nodes.find(id) != nodes.end();
@@ -46,58 +168,60 @@ nlohmann::json GraphDB::getAllNodes(
     const std::string& sortBy,
     const std::string& order,
     int limit,
-    int offset
+    int offset,
+    uint32_t fields
 ) const
 {
-    nlohmann::json result = nlohmann::json::array();
+    return findNodes({}, sortBy, order, limit, offset, fields);
+}
 
-    // Collect all nodes into a vector for sorting
-    std::vector<Node*> node_list;
-    for (const auto& [id, node] : nodes) {
-        node_list.push_back(node);
-    }
-
-    // Sort nodes based on sortBy parameter
-    std::sort(node_list.begin(), node_list.end(),
-        [&sortBy, &order](const Node* a, const Node* b) {
-            bool ascending = (order == "asc");
-
-            if (sortBy == "id") {
-                return ascending ? (a->getId() < b->getId()) : (a->getId() > b->getId());
-            } else if (sortBy == "title") {
-                return ascending ? (a->getTitle() < b->getTitle()) : (a->getTitle() > b->getTitle());
-            } else if (sortBy == "author") {
-                return ascending ? (a->getAuthor() < b->getAuthor()) : (a->getAuthor() > b->getAuthor());
-            } else if (sortBy == "subject") {
-                return ascending ? (a->getSubject() < b->getSubject()) : (a->getSubject() > b->getSubject());
-            } else if (sortBy == "course") {
-                return ascending ? (a->getCourse() < b->getCourse()) : (a->getCourse() > b->getCourse());
-            } else if (sortBy == "date") {
-                return ascending ? (a->getDate() < b->getDate()) : (a->getDate() > b->getDate());
-            } else {
-                // Default: sort by ID
-                return ascending ? (a->getId() < b->getId()) : (a->getId() > b->getId());
-            }
+nlohmann::json GraphDB::findNodes(
+    const std::unordered_map<std::string, std::string>& filters,
+    const std::string& sortBy,
+    const std::string& order,
+    int limit,
+    int offset,
+    uint32_t fields,
+    nlohmann::json* explain
+) const
+{
+    if (sortBy == "rank") {
+        prepareRanks();
+    }
+    std::string key = queryKey("find", filters, sortBy, order, limit, offset, fields, rankVersion_);
+    nlohmann::json cached;
+    if (queryCache_.get(key, generation_, cached)) {
+        // No plan ran: EXPLAIN only says where the rows came from
+        if (explain) {
+            *explain = {{"cacheHit", true}, {"rowsReturned", cached.size()}};
         }
-    );
+        return cached;
+    }
 
-    // Apply offset and limit
-    size_t start = (offset >= 0) ? static_cast<size_t>(offset) : 0;
-    size_t end = node_list.size();
+    QueryPlan plan;
+    ParsedFilters parsed;
+    std::vector<Node*> page = runQuery(filters, sortBy, order, limit, offset, plan, parsed);
 
-    if (limit > 0) {
-        end = std::min(start + static_cast<size_t>(limit), node_list.size());
+    // Serialize the requested page
+    auto t = std::chrono::steady_clock::now();
+    nlohmann::json result = nlohmann::json::array();
+    for (const Node* node : page) {
+        result.push_back(node->to_json(fields));
     }
+    plan.rowsReturned = result.size();
+    plan.serializeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t).count();
 
-    // Build result array
-    for (size_t i = start; i < end; ++i) {
-        result.push_back(node_list[i]->to_json());
+    // Pages with embeddings (ALL_FIELDS included) would fill the cache with vectors
+    if (!(fields & FIELD_EMBEDDING)) {
+        queryCache_.put(key, generation_, result);
+    }
+    if (explain) {
+        *explain = plan.to_json(parsed.predicates);
     }
-
     return result;
 }
 
-nlohmann::json GraphDB::findNodes(
+std::vector<const Node*> GraphDB::queryNodes(
     const std::unordered_map<std::string, std::string>& filters,
     const std::string& sortBy,
     const std::string& order,
@@ -105,76 +229,111 @@ nlohmann::json GraphDB::findNodes(
     int offset
 ) const
 {
-    // First, filter nodes
-    std::vector<Node*> filtered_nodes;
-
-    for (const auto& [id, node] : nodes) {
-        bool match = true;
-
-        for (const auto& [key, value] : filters) {
-            if (key == "subject") {
-                if (node->getSubject() != value) match = false;
-            } else if (key == "author") {
-                if (node->getAuthor() != value) match = false;
-            } else if (key == "course") {
-                try {
-                    if (node->getCourse() != std::stoi(value)) match = false;
-                } catch (...) { match = false; }
-            } else if (key == "title") {
-                // Partial match for title
-                if (node->getTitle().find(value) == std::string::npos) match = false;
-            } else if (key == "tag") {
-                // Check if tag exists
-                auto tags = node->getTags();
-                bool hasTag = std::find(tags.begin(), tags.end(), value) != tags.end();
-                if (!hasTag) match = false;
-            }
-
-            if (!match) break;
-        }
-
-        if (match) {
-            filtered_nodes.push_back(node);
-        }
-    }
-
-    // Sort filtered nodes
-    std::sort(filtered_nodes.begin(), filtered_nodes.end(),
-        [&sortBy, &order](const Node* a, const Node* b) {
-            bool ascending = (order == "asc");
-
-            if (sortBy == "id") {
-                return ascending ? (a->getId() < b->getId()) : (a->getId() > b->getId());
-            } else if (sortBy == "title") {
-                return ascending ? (a->getTitle() < b->getTitle()) : (a->getTitle() > b->getTitle());
-            } else if (sortBy == "author") {
-                return ascending ? (a->getAuthor() < b->getAuthor()) : (a->getAuthor() > b->getAuthor());
-            } else if (sortBy == "subject") {
-                return ascending ? (a->getSubject() < b->getSubject()) : (a->getSubject() > b->getSubject());
-            } else if (sortBy == "course") {
-                return ascending ? (a->getCourse() < b->getCourse()) : (a->getCourse() > b->getCourse());
-            } else if (sortBy == "date") {
-                return ascending ? (a->getDate() < b->getDate()) : (a->getDate() > b->getDate());
-            } else {
-                return ascending ? (a->getId() < b->getId()) : (a->getId() > b->getId());
-            }
+    // Only the page's ids are cached; callers serialize straight from the nodes
+    if (sortBy == "rank") {
+        prepareRanks();
+    }
+    std::string key = queryKey("page", filters, sortBy, order, limit, offset, 0, rankVersion_);
+    std::vector<const Node*> page;
+    nlohmann::json cached;
+    if (queryCache_.get(key, generation_, cached)) {
+        page.reserve(cached.size());
+        for (const auto& id : cached) {
+            page.push_back(nodeById(id.get<uint32_t>()));
         }
-    );
+        return page;
+    }
 
-    // Apply offset and limit
-    nlohmann::json result = nlohmann::json::array();
+    QueryPlan plan;
+    ParsedFilters parsed;
+    std::vector<Node*> matched = runQuery(filters, sortBy, order, limit, offset, plan, parsed);
+
+    nlohmann::json ids = nlohmann::json::array();
+    page.reserve(matched.size());
+    for (const Node* node : matched) {
+        page.push_back(node);
+        ids.push_back(node->getId());
+    }
+    queryCache_.put(key, generation_, std::move(ids));
+    return page;
+}
+
+const Node* GraphDB::getNode(const std::string& id) const
+{
+    auto it = nodes.find(id);
+    return it != nodes.end() ? it->second : nullptr;
+}
+
+std::vector<Node*> GraphDB::runQuery(
+    const std::unordered_map<std::string, std::string>& filters,
+    const std::string& sortBy,
+    const std::string& order,
+    int limit,
+    int offset,
+    QueryPlan& plan,
+    ParsedFilters& parsed
+) const
+{
+    using Clock = std::chrono::steady_clock;
+    auto elapsedUs = [](Clock::time_point from) {
+        return std::chrono::duration<double, std::micro>(Clock::now() - from).count();
+    };
+
+    // Plan
+    auto t = Clock::now();
+    parsed = parseFilters(filters);
+
+    QueryPlanner::Input input;
+    input.totalRows = nodes.size();
+    input.predicates = &parsed.predicates;
+    input.sortBy = (sortBy == "title" || sortBy == "author" || sortBy == "subject" ||
+                    sortBy == "course" || sortBy == "date" || sortBy == "rank") ? sortBy : "id";
+    input.ascending = (order == "asc");
+    input.limit = limit;
+    input.offset = offset;
+    input.orderedIndex = hasOrderedIndex(input.sortBy);
+
+    plan = QueryPlanner::plan(input);
+    plan.planUs = elapsedUs(t);
+
+    // Execute access path
+    t = Clock::now();
     size_t start = (offset >= 0) ? static_cast<size_t>(offset) : 0;
-    size_t end = filtered_nodes.size();
+    size_t needed = (limit > 0) ? start + static_cast<size_t>(limit) : 0;
+    std::vector<Node*> matched;
+    if (!parsed.matchesNothing) {
+        matched = executePlan(plan, parsed.predicates, needed);
+    }
+    plan.executeUs = elapsedUs(t);
 
+    // Sort (top-k when limited)
+    t = Clock::now();
+    size_t end = matched.size();
     if (limit > 0) {
-        end = std::min(start + static_cast<size_t>(limit), filtered_nodes.size());
+        end = std::min(needed, matched.size());
     }
-
-    for (size_t i = start; i < end; ++i) {
-        result.push_back(filtered_nodes[i]->to_json());
+    if (!plan.sortedByIndex && !plan.sortedByScan) {
+        const std::string& field = input.sortBy;
+        bool ascending = input.ascending;
+        const std::vector<float>* ranks = &rankColumn_;
+        auto less = [&field, ascending, ranks](const Node* a, const Node* b) {
+            return nodeLess(a, b, field, ascending, ranks);
+        };
+        if (end < matched.size()) {
+            std::partial_sort(matched.begin(), matched.begin() + end, matched.end(), less);
+        } else {
+            std::sort(matched.begin(), matched.end(), less);
+        }
     }
+    plan.sortUs = elapsedUs(t);
 
-    return result;
+    // Keep only the requested page
+    if (start >= end) {
+        return {};
+    }
+    matched.resize(end);
+    matched.erase(matched.begin(), matched.begin() + start);
+    return matched;
 }
 
 bool GraphDB::updateNode(const std::string& id, const nlohmann::json& updates)
@@ -184,7 +343,49 @@ bool GraphDB::updateNode(const std::string& id, const nlohmann::json& updates)
         return false;
     }
 
+    // Tag- and link-derived structures survive updates that leave them alone
+    uint64_t tagGeneration = tagGeneration_;
+    uint64_t linkGeneration = linkGeneration_;
+    std::vector<TagId> oldTags = it->second->getTagIds();
+    std::vector<int> oldLinks = it->second->getLinkedNodes();
+
+    unindexNode(*it->second);
     it->second->updateFromJson(updates);
+    indexNode(*it->second);
+    if (it->second->getTagIds() == oldTags) {
+        tagGeneration_ = tagGeneration;
+    }
+    const auto& newLinks = it->second->getLinkedNodes();
+    int nodeId = it->second->getId();
+    if (newLinks == oldLinks) {
+        linkGeneration_ = linkGeneration;
+    } else {
+        // Mirror the edit on the other ends so links stay symmetric
+        for (int link : newLinks) {
+            Node* other = link != nodeId ? nodeById(static_cast<uint32_t>(link)) : nullptr;
+            if (other && std::find(oldLinks.begin(), oldLinks.end(), link) == oldLinks.end()) {
+                appendLink(*other, nodeId);
+            }
+        }
+        std::vector<int> dropped;
+        for (int link : oldLinks) {
+            if (std::find(newLinks.begin(), newLinks.end(), link) == newLinks.end()) {
+                dropped.push_back(link);
+                if (Node* other = nodeById(static_cast<uint32_t>(link))) {
+                    dropLink(*other, nodeId);
+                }
+            }
+        }
+        if (!dropped.empty()) {
+            componentsDirty_ = true; // A link went away
+            forgetEdges(nodeId, dropped);
+        }
+    }
+    bumpGeneration();
+    syncLinkCheck();
+    syncRanks();
+    syncLayout();
+    syncCommunities();
     saveToJson();
     return true;
 }
@@ -196,192 +397,948 @@ int GraphDB::countNodes(const std::unordered_map<std::string, std::string>& filt
         return static_cast<int>(nodes.size());
     }
 
-    // Count nodes matching filters
+    std::string key = queryKey("count", filters, "id", "asc", -1, 0, 0);
+    nlohmann::json cached;
+    if (queryCache_.get(key, generation_, cached)) {
+        return cached.get<int>();
+    }
+
     int count = 0;
-    for (const auto& [id, node] : nodes) {
-        bool match = true;
-
-        for (const auto& [key, value] : filters) {
-            if (key == "subject") {
-                if (node->getSubject() != value) match = false;
-            } else if (key == "author") {
-                if (node->getAuthor() != value) match = false;
-            } else if (key == "course") {
-                try {
-                    if (node->getCourse() != std::stoi(value)) match = false;
-                } catch (...) { match = false; }
-            } else if (key == "title") {
-                if (node->getTitle().find(value) == std::string::npos) match = false;
-            } else if (key == "tag") {
-                auto tags = node->getTags();
-                bool hasTag = std::find(tags.begin(), tags.end(), value) != tags.end();
-                if (!hasTag) match = false;
-            }
-
-            if (!match) break;
-        }
-
-        if (match) {
-            count++;
+    ParsedFilters parsed = parseFilters(filters);
+
+    if (!parsed.matchesNothing) {
+        // Materialize indexed predicates, smallest first
+        std::vector<size_t> indexed, residual;
+        for (size_t i = 0; i < parsed.predicates.size(); ++i) {
+            (parsed.predicates[i].indexed ? indexed : residual).push_back(i);
+        }
+        std::sort(indexed.begin(), indexed.end(), [&parsed](size_t a, size_t b) {
+            return parsed.predicates[a].estimate < parsed.predicates[b].estimate;
+        });
+
+        std::deque<RoaringBitmap> scratch;
+        std::vector<const RoaringBitmap*> postings;
+        for (size_t i : indexed) {
+            postings.push_back(&postingFor(parsed.predicates[i], scratch));
+        }
+
+        if (residual.empty() && !postings.empty()) {
+            // Pure index query: answer from intersection cardinality
+            if (postings.size() == 1) {
+                count = static_cast<int>(postings[0]->cardinality());
+            } else {
+                RoaringBitmap acc = *postings[0];
+                for (size_t i = 1; i + 1 < postings.size(); ++i) {
+                    acc &= *postings[i];
+                }
+                count = static_cast<int>(acc.andCardinality(*postings.back()));
+            }
+        } else {
+            RoaringBitmap candidates = postings.empty() ? allNodes_ : *postings[0];
+            for (size_t i = 1; i < postings.size() && !candidates.empty(); ++i) {
+                candidates &= *postings[i];
+            }
+            count = static_cast<int>(countMatches(candidates, parsed.predicates, residual));
         }
     }
 
+    queryCache_.put(key, generation_, count);
     return count;
 }
 
-std::string GraphDB::serialize() const
+nlohmann::json GraphDB::getFacets(const std::unordered_map<std::string, std::string>& filters, int limit) const
 {
-    std::vector<nlohmann::json> nodes_json;
-    nodes_json.reserve(nodes.size());
+    std::string key = queryKey("facets", filters, "id", "asc", limit, 0, 0);
+    nlohmann::json cached;
+    if (queryCache_.get(key, generation_, cached)) {
+        return cached;
+    }
 
-    for (const auto& node_pair : nodes) {
-        nodes_json.push_back(node_pair.second->to_json());
+    // Matching set: indexed predicates intersected, residual ones checked per row
+    RoaringBitmap matching;
+    bool unfiltered = filters.empty();
+    if (!unfiltered) {
+        ParsedFilters parsed = parseFilters(filters);
+        if (!parsed.matchesNothing) {
+            matching = matchingBitmap(parsed);
+        }
+    }
+    uint64_t total = unfiltered ? allNodes_.cardinality() : matching.cardinality();
+
+    std::unordered_map<std::string, uint64_t> subjects, authors;
+    std::map<int, uint64_t> courses;
+    std::vector<uint64_t> tagCounts(tagPostings_.size(), 0); // By TagId
+    uint64_t postings = subjectIndex_.size() + authorIndex_.size() + courseIndex_.size() + tagPostings_.size();
+
+    if (unfiltered) {
+        // Facets of the whole store are the posting sizes
+        for (const auto& [value, bitmap] : subjectIndex_) subjects[value] = bitmap.cardinality();
+        for (const auto& [value, bitmap] : authorIndex_) authors[value] = bitmap.cardinality();
+        for (const auto& [value, bitmap] : courseIndex_) courses[value] = bitmap.cardinality();
+        for (TagId id = 0; id < tagPostings_.size(); ++id) tagCounts[id] = tags_.usage(id);
+    } else if (total < postings) {
+        // Few matches: one pass over the matching nodes is cheaper than
+        // intersecting every posting
+        matching.forEach([&](uint32_t id) {
+            if (const Node* node = nodeById(id)) {
+                subjects[node->getSubject()]++;
+                authors[node->getAuthor()]++;
+                courses[node->getCourse()]++;
+                for (TagId tag : node->getTagIds()) tagCounts[tag]++;
+            }
+            return true;
+        });
+    } else if (total > 0) {
+        for (const auto& [value, bitmap] : subjectIndex_) subjects[value] = matching.andCardinality(bitmap);
+        for (const auto& [value, bitmap] : authorIndex_) authors[value] = matching.andCardinality(bitmap);
+        for (const auto& [value, bitmap] : courseIndex_) courses[value] = matching.andCardinality(bitmap);
+        for (TagId id = 0; id < tagPostings_.size(); ++id) tagCounts[id] = matching.andCardinality(tagPostings_[id]);
     }
 
-    nlohmann::json j;
-    j["nodes"] = nodes_json;
+    std::unordered_map<std::string, uint64_t> tags;
+    for (TagId id = 0; id < tagCounts.size(); ++id) {
+        if (tagCounts[id] > 0) tags[tags_.name(id)] = tagCounts[id];
+    }
 
-    return j.dump();
-}
+    // Buckets ordered by count (desc), then value; empty buckets dropped
+    auto buckets = [limit](const auto& counts) {
+        using Entry = std::pair<typename std::decay_t<decltype(counts)>::key_type, uint64_t>;
+        std::vector<Entry> entries;
+        for (const auto& [value, count] : counts) {
+            if (count > 0) entries.emplace_back(value, count);
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        if (limit > 0 && entries.size() > static_cast<size_t>(limit)) {
+            entries.resize(static_cast<size_t>(limit));
+        }
 
-void GraphDB::loadFromJson() {
-    try {
-        std::ifstream file(DB_FILE_PATH);
-        if (!file.is_open()) {
-            throw std::runtime_error("Failed to open database file");
+        nlohmann::json out = nlohmann::json::array();
+        for (const auto& [value, count] : entries) {
+            out.push_back({{"value", value}, {"count", count}});
         }
+        return out;
+    };
+
+    nlohmann::json result;
+    result["total"] = total;
+    result["facets"] = {
+        {"subject", buckets(subjects)},
+        {"author", buckets(authors)},
+        {"course", buckets(courses)},
+        {"tag", buckets(tags)}
+    };
+
+    queryCache_.put(key, generation_, result);
+    return result;
+}
 
-        nlohmann::json j;
-        file >> j;
+RoaringBitmap GraphDB::matchingBitmap(const ParsedFilters& parsed) const
+{
+    std::vector<size_t> indexed, residual;
+    for (size_t i = 0; i < parsed.predicates.size(); ++i) {
+        (parsed.predicates[i].indexed ? indexed : residual).push_back(i);
+    }
+    std::sort(indexed.begin(), indexed.end(), [&parsed](size_t a, size_t b) {
+        return parsed.predicates[a].estimate < parsed.predicates[b].estimate;
+    });
+
+    std::deque<RoaringBitmap> scratch;
+    RoaringBitmap candidates = indexed.empty() ? allNodes_ : postingFor(parsed.predicates[indexed[0]], scratch);
+    for (size_t i = 1; i < indexed.size() && !candidates.empty(); ++i) {
+        candidates &= postingFor(parsed.predicates[indexed[i]], scratch);
+    }
+    if (residual.empty()) {
+        return candidates;
+    }
 
-        // Clear existing nodes
-        for (auto& pair : nodes) {
-            delete pair.second;
+    std::vector<uint32_t> ids;
+    candidates.forEach([&](uint32_t id) {
+        Node* node = nodeById(id);
+        if (node && matchesAll(*node, parsed.predicates, residual)) {
+            ids.push_back(id);
         }
-        nodes.clear();
-        nodeFiles.clear();
-        size = 0;
+        return true;
+    });
+    return bitmapFromIds(ids);
+}
 
-        // Load nodes
-        if (j.contains("nodes") && j["nodes"].is_array()) {
-            for (const auto& nodeJson : j["nodes"]) {
-                Node* node = new Node(nodeJson);
-                std::string nodeId = std::to_string(node->getId());
-                nodes[nodeId] = node;
-                size++;
-            }
+GraphDB::ParsedFilters GraphDB::parseFilters(const std::unordered_map<std::string, std::string>& filters) const
+{
+    ParsedFilters parsed;
+    uint64_t total = nodes.size();
+
+    auto probe = [&parsed](const auto& index, const auto& key, QueryPredicate p) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            parsed.matchesNothing = true;
+            return;
         }
-        
-        // Load file associations
-        if (j.contains("nodeFiles") && j["nodeFiles"].is_object()) {
-            for (auto it = j["nodeFiles"].begin(); it != j["nodeFiles"].end(); ++it) {
-                std::string nodeId = it.key();
-                if (it.value().is_array()) {
-                    for (const auto& filePath : it.value()) {
-                        nodeFiles[nodeId].push_back(filePath);
-                    }
-                }
+        p.posting = &it->second;
+        p.estimate = it->second.cardinality();
+        p.indexed = true;
+        parsed.predicates.push_back(std::move(p));
+    };
+
+    auto parseInt = [&parsed](const std::string& value, int64_t& out) {
+        try {
+            out = std::stoi(value);
+            return true;
+        } catch (...) {
+            parsed.matchesNothing = true;
+            return false;
+        }
+    };
+
+    // Range bounds are gathered first so each column is scanned once
+    bool courseRange = false, dateRange = false;
+    int64_t courseMin = std::numeric_limits<int>::min(), courseMax = std::numeric_limits<int>::max();
+    int64_t dateFrom = std::numeric_limits<int64_t>::min() + 1, dateTo = std::numeric_limits<int64_t>::max();
+
+    for (const auto& [key, value] : filters) {
+        QueryPredicate p;
+        p.field = key;
+        p.value = value;
+
+        if (key == "subject") {
+            probe(subjectIndex_, value, p);
+        } else if (key == "author") {
+            probe(authorIndex_, value, p);
+        } else if (key == "tag") {
+            TagId tag = tags_.find(value);
+            // Bank-only tags have no posting yet
+            if (tag >= tagPostings_.size() || tagPostings_[tag].empty()) {
+                parsed.matchesNothing = true;
+            } else {
+                p.lo = p.hi = tag;
+                p.posting = &tagPostings_[tag];
+                p.estimate = tags_.usage(tag);
+                p.indexed = true;
+                parsed.predicates.push_back(std::move(p));
+            }
+        } else if (key == "course") {
+            if (parseInt(value, p.lo)) {
+                p.hi = p.lo;
+                probe(courseIndex_, static_cast<int>(p.lo), p);
             }
+        } else if (key == "community") {
+            if (parseInt(value, p.lo)) {
+                p.hi = p.lo;
+                probe(communityIndex_, static_cast<int>(p.lo), p);
+            }
+        } else if (key == "course_min") {
+            courseRange = parseInt(value, courseMin) || courseRange;
+        } else if (key == "course_max") {
+            courseRange = parseInt(value, courseMax) || courseRange;
+        } else if (key == "date_from" || key == "date_to") {
+            bool wholeDay = false;
+            auto epoch = Node::parseDate(value, &wholeDay);
+            if (!epoch) {
+                parsed.matchesNothing = true;
+            } else if (key == "date_from") {
+                dateFrom = *epoch;
+            } else {
+                // A bare day ("2024-03-01") includes the whole day
+                dateTo = wholeDay ? *epoch + 86399 : *epoch;
+            }
+            dateRange = true;
+        } else if (key == "title") {
+            p.estimate = static_cast<uint64_t>(total * QueryPlanner::SUBSTRING_SELECTIVITY);
+            parsed.predicates.push_back(std::move(p));
         }
 
-        // Load tag bank
-        tagBank_.clear();
-        if (j.contains("tagBank") && j["tagBank"].is_array()) {
-            tagBank_ = j["tagBank"].get<std::vector<std::string>>();
+        if (parsed.matchesNothing) {
+            return parsed;
         }
-
-        setSize(j.value("size", 0));
-    } catch (const nlohmann::json::parse_error& e) {
-        std::cerr << "JSON parse error: " << e.what() << std::endl;
-        createJson();
-    } catch (const std::exception& e) {
-        std::cerr << "Error loading database: " << e.what() << std::endl;
-        createJson();
     }
-}
-
-void GraphDB::createJson() {
-    nodes.clear();
-    tagBank_.clear();
-    this->setSize(0);
 
-    // Создаем директорию если не существует
-    std::filesystem::path dbPath(DB_FILE_PATH);
-    if (dbPath.has_parent_path()) {
-        std::filesystem::create_directories(dbPath.parent_path());
+    if (courseRange) {
+        QueryPredicate p;
+        p.field = "course_range";
+        p.lo = courseMin;
+        p.hi = courseMax;
+        p.indexed = true;
+        // Few distinct courses: exact count from the postings
+        if (courseMin <= courseMax) {
+            for (auto it = courseIndex_.lower_bound(static_cast<int>(courseMin));
+                 it != courseIndex_.end() && it->first <= courseMax; ++it) {
+                p.estimate += it->second.cardinality();
+            }
+        }
+        parsed.predicates.push_back(p);
+        if (p.estimate == 0) {
+            parsed.matchesNothing = true;
+        }
     }
 
-    std::ofstream file(DB_FILE_PATH);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to create database file: " + DB_FILE_PATH);
+    if (dateRange) {
+        QueryPredicate p;
+        p.field = "date_range";
+        p.lo = dateFrom;
+        p.hi = dateTo;
+        p.indexed = true;
+        if (dateIndex_.empty() || dateFrom > dateTo ||
+            dateTo < dateIndex_.begin()->first || dateFrom > dateIndex_.rbegin()->first) {
+            parsed.matchesNothing = true;
+        } else {
+            // Assume dates are spread uniformly between the oldest and newest node
+            double minDate = static_cast<double>(dateIndex_.begin()->first);
+            double maxDate = static_cast<double>(dateIndex_.rbegin()->first);
+            double lo = std::max(static_cast<double>(dateFrom), minDate);
+            double hi = std::min(static_cast<double>(dateTo), maxDate);
+            double fraction = (maxDate > minDate) ? (hi - lo + 1.0) / (maxDate - minDate + 1.0) : 1.0;
+            p.estimate = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * dateIndex_.size()));
+        }
+        parsed.predicates.push_back(p);
     }
 
-    nlohmann::json j;
-    j["nodes"] = nlohmann::json::array();
-    j["tagBank"] = nlohmann::json::array();
-    j["size"] = getSize();
-    file << j.dump(4);
+    return parsed;
 }
 
-void GraphDB::saveToJson() {
-    // Создаем директорию если не существует
-    std::filesystem::path dbPath(DB_FILE_PATH);
-    if (dbPath.has_parent_path()) {
-        std::filesystem::create_directories(dbPath.parent_path());
-    }
-
-    std::ofstream file(DB_FILE_PATH);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open database file for writing: " + DB_FILE_PATH);
+const RoaringBitmap& GraphDB::postingFor(const QueryPredicate& p, std::deque<RoaringBitmap>& scratch) const
+{
+    if (p.posting) {
+        return *p.posting;
     }
 
-    nlohmann::json j;
-    j["size"] = size;
-    j["nodes"] = nlohmann::json::array();
-    
-    // Convert node IDs to integers for sorting
-    std::vector<std::pair<int, Node*>> sorted_nodes;
-    for (const auto& pair : nodes) {
-        try {
-            int nodeId = std::stoi(pair.first);
-            sorted_nodes.emplace_back(nodeId, pair.second);
-        } catch (const std::exception& e) {
-            // If node ID is not a number, skip sorting for this node
-            j["nodes"].push_back(pair.second->to_json());
+    RoaringBitmap range;
+    if (p.field == "course_range") {
+        for (auto it = courseIndex_.lower_bound(static_cast<int>(p.lo));
+             it != courseIndex_.end() && it->first <= p.hi; ++it) {
+            range |= it->second;
         }
+    } else if (p.field == "date_range") {
+        std::vector<uint32_t> ids;
+        for (auto it = dateIndex_.lower_bound({p.lo, 0});
+             it != dateIndex_.end() && it->first <= p.hi; ++it) {
+            ids.push_back(it->second);
+        }
+        range = bitmapFromIds(ids);
     }
-    
-    // Sort nodes by numeric ID
-    std::sort(sorted_nodes.begin(), sorted_nodes.end(),
-             [](const auto& a, const auto& b) {
-                  return a.first < b.first;
-              });
+    scratch.push_back(std::move(range));
+    return scratch.back();
+}
 
-    // Add sorted nodes to JSON
-    for (const auto& [_, node] : sorted_nodes) {
-        j["nodes"].push_back(node->to_json());
+bool GraphDB::hasOrderedIndex(const std::string& sortBy) const
+{
+    if (sortBy == "id" || sortBy == "course") {
+        return true;
     }
+    // Undated nodes are missing from the date index, so it only covers the
+    // sort order when every node has a date
+    return sortBy == "date" && dateIndex_.size() == nodes.size();
+}
 
-    // Save file associations
-    for (const auto& [nodeId, files] : nodeFiles) {
-        j["nodeFiles"][nodeId] = files;
+std::vector<Node*> GraphDB::executePlan(QueryPlan& plan, const std::vector<QueryPredicate>& predicates, size_t needed) const
+{
+    std::vector<Node*> matched;
+    uint64_t examined = 0;
+
+    // Returns false to stop the walk once enough rows are collected
+    auto visit = [&](uint32_t id) {
+        examined++;
+        Node* node = nodeById(id);
+        if (node && matchesAll(*node, predicates, plan.residual)) {
+            matched.push_back(node);
+            if (plan.sortedByIndex && needed > 0 && matched.size() >= needed) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::deque<RoaringBitmap> scratch;
+
+    // Unordered access paths hand their candidate set to the parallel scan
+    // once it is large enough to amortize the fork/join
+    auto scan = [&](const RoaringBitmap& candidates) {
+        if (getScanThreads() > 1 && candidates.cardinality() >= parallelScanThreshold_) {
+            matched = parallelScan(candidates, plan, predicates, needed);
+            examined = plan.rowsExamined;
+        } else {
+            candidates.forEach(visit);
+            plan.rowsMatched = matched.size();
+        }
+    };
+
+    switch (plan.access) {
+        case AccessPath::FULL_SCAN:
+            scan(allNodes_);
+            break;
+
+        case AccessPath::INDEX_PROBE:
+            scan(postingFor(predicates[plan.indexed[0]], scratch));
+            break;
+
+        case AccessPath::BITMAP_INTERSECTION: {
+            RoaringBitmap acc = postingFor(predicates[plan.indexed[0]], scratch);
+            for (size_t i = 1; i < plan.indexed.size() && !acc.empty(); ++i) {
+                acc &= postingFor(predicates[plan.indexed[i]], scratch);
+            }
+            scan(acc);
+            break;
+        }
+
+        case AccessPath::ORDERED_INDEX_WALK: {
+            bool stopped = false;
+            auto walk = [&](uint32_t id) {
+                if (!visit(id)) {
+                    stopped = true;
+                    return false;
+                }
+                return true;
+            };
+
+            if (plan.sortBy == "course") {
+                if (plan.ascending) {
+                    for (auto it = courseIndex_.begin(); it != courseIndex_.end() && !stopped; ++it) {
+                        it->second.forEach(walk);
+                    }
+                } else {
+                    for (auto it = courseIndex_.rbegin(); it != courseIndex_.rend() && !stopped; ++it) {
+                        it->second.forEachReverse(walk);
+                    }
+                }
+            } else if (plan.sortBy == "date") {
+                if (plan.ascending) {
+                    for (auto it = dateIndex_.begin(); it != dateIndex_.end() && walk(it->second); ++it) {}
+                } else {
+                    for (auto it = dateIndex_.rbegin(); it != dateIndex_.rend() && walk(it->second); ++it) {}
+                }
+            } else if (plan.ascending) {
+                allNodes_.forEach(walk);
+            } else {
+                allNodes_.forEachReverse(walk);
+            }
+            plan.rowsMatched = matched.size();
+            break;
+        }
     }
 
-    // Save tag bank
-    j["tagBank"] = tagBank_;
+    plan.rowsExamined = examined;
+    return matched;
+}
 
-    file << j.dump(4);
+size_t GraphDB::getScanThreads() const
+{
+    size_t poolSize = ThreadPool::global().size();
+    return scanThreads_ == 0 ? poolSize : std::min(scanThreads_, poolSize);
 }
 
-std::string GraphDB::addNode(nlohmann::json& j, const std::vector<std::pair<std::string, std::string>>& files) {
-    std::string id = generateNodeId();
-    j["id"] = std::stoi(id);  // Add the ID to the JSON object
-    Node* node = new Node(j);  // Use the JSON constructor
-    nodes[id] = node;
-    size++;
-    
-    // Add files to the node
-    for (const auto& file : files) {
+std::vector<Node*> GraphDB::parallelScan(const RoaringBitmap& candidates, QueryPlan& plan,
+                                         const std::vector<QueryPredicate>& predicates, size_t needed) const
+{
+    // Morsels are index ranges over the candidate ids; workers pull them
+    // dynamically so skewed predicate costs even out
+    std::vector<uint32_t> ids = candidates.toVector();
+    size_t slots = getScanThreads();
+
+    const std::string& field = plan.sortBy;
+    bool ascending = plan.ascending;
+    const std::vector<float>* ranks = &rankColumn_;
+    auto less = [&field, ascending, ranks](const Node* a, const Node* b) {
+        return nodeLess(a, b, field, ascending, ranks);
+    };
+
+    // Per-worker output: all matches, or a bounded max-heap of the best
+    // `needed` rows when the query is limited
+    std::vector<std::vector<Node*>> runs(slots);
+    std::vector<uint64_t> matchCounts(slots, 0);
+
+    ThreadPool& pool = ThreadPool::global();
+    plan.workers = pool.parallelFor(ids.size(), SCAN_MORSEL_SIZE, [&](size_t begin, size_t end, size_t worker) {
+        std::vector<Node*>& run = runs[worker];
+        uint64_t count = 0;
+        for (size_t i = begin; i < end; ++i) {
+            Node* node = nodeById(ids[i]);
+            if (!node || !matchesAll(*node, predicates, plan.residual)) {
+                continue;
+            }
+            count++;
+            if (needed == 0) {
+                run.push_back(node);
+            } else if (run.size() < needed) {
+                run.push_back(node);
+                std::push_heap(run.begin(), run.end(), less);
+            } else if (less(node, run.front())) {
+                std::pop_heap(run.begin(), run.end(), less);
+                run.back() = node;
+                std::push_heap(run.begin(), run.end(), less);
+            }
+        }
+        matchCounts[worker] += count;
+    }, slots);
+
+    // Sort each run on its own worker
+    pool.parallelFor(runs.size(), 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t r = begin; r < end; ++r) {
+            if (needed > 0) {
+                std::sort_heap(runs[r].begin(), runs[r].end(), less);
+            } else {
+                std::sort(runs[r].begin(), runs[r].end(), less);
+            }
+        }
+    }, slots);
+
+    // Pairwise merge of the sorted runs, trimming to top-k as we go
+    while (runs.size() > 1) {
+        std::vector<std::vector<Node*>> merged((runs.size() + 1) / 2);
+        pool.parallelFor(merged.size(), 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t m = begin; m < end; ++m) {
+                if (2 * m + 1 == runs.size()) {
+                    merged[m] = std::move(runs[2 * m]);
+                    continue;
+                }
+                const auto& a = runs[2 * m];
+                const auto& b = runs[2 * m + 1];
+                merged[m].resize(a.size() + b.size());
+                std::merge(a.begin(), a.end(), b.begin(), b.end(), merged[m].begin(), less);
+                if (needed > 0 && merged[m].size() > needed) {
+                    merged[m].resize(needed);
+                }
+            }
+        }, slots);
+        runs = std::move(merged);
+    }
+
+    plan.rowsExamined = ids.size();
+    plan.rowsMatched = 0;
+    for (uint64_t count : matchCounts) {
+        plan.rowsMatched += count;
+    }
+    plan.sortedByScan = true;
+    return runs.empty() ? std::vector<Node*>() : std::move(runs[0]);
+}
+
+uint64_t GraphDB::countMatches(const RoaringBitmap& candidates,
+                               const std::vector<QueryPredicate>& predicates, const std::vector<size_t>& which) const
+{
+    uint64_t total = candidates.cardinality();
+    if (getScanThreads() <= 1 || total < parallelScanThreshold_) {
+        uint64_t count = 0;
+        candidates.forEach([&](uint32_t id) {
+            Node* node = nodeById(id);
+            if (node && matchesAll(*node, predicates, which)) {
+                count++;
+            }
+            return true;
+        });
+        return count;
+    }
+
+    std::vector<uint32_t> ids = candidates.toVector();
+    std::atomic<uint64_t> count{0};
+    ThreadPool::global().parallelFor(ids.size(), SCAN_MORSEL_SIZE, [&](size_t begin, size_t end, size_t) {
+        uint64_t local = 0;
+        for (size_t i = begin; i < end; ++i) {
+            Node* node = nodeById(ids[i]);
+            if (node && matchesAll(*node, predicates, which)) {
+                local++;
+            }
+        }
+        count += local;
+    }, getScanThreads());
+    return count.load();
+}
+
+bool GraphDB::matchesAll(const Node& node, const std::vector<QueryPredicate>& predicates, const std::vector<size_t>& which)
+{
+    for (size_t i : which) {
+        const QueryPredicate& p = predicates[i];
+        if (p.field == "subject") {
+            if (node.getSubject() != p.value) return false;
+        } else if (p.field == "author") {
+            if (node.getAuthor() != p.value) return false;
+        } else if (p.field == "course" || p.field == "course_range") {
+            if (node.getCourse() < p.lo || node.getCourse() > p.hi) return false;
+        } else if (p.field == "community") {
+            if (node.getCommunity() != p.lo) return false;
+        } else if (p.field == "date_range") {
+            if (!node.hasDate() || node.getDateEpoch() < p.lo || node.getDateEpoch() > p.hi) return false;
+        } else if (p.field == "title") {
+            // Partial match for title
+            if (node.getTitle().find(p.value) == std::string::npos) return false;
+        } else if (p.field == "tag") {
+            const auto& tags = node.getTagIds();
+            if (!std::binary_search(tags.begin(), tags.end(), static_cast<TagId>(p.lo))) return false;
+        }
+    }
+    return true;
+}
+
+Node* GraphDB::nodeById(uint32_t id) const
+{
+    return id < byId_.size() ? byId_[id] : nullptr;
+}
+
+void GraphDB::indexNode(Node& node)
+{
+    uint32_t id = static_cast<uint32_t>(node.getId());
+    if (id >= byId_.size()) {
+        byId_.resize(static_cast<size_t>(id) + 1, nullptr);
+    }
+    byId_[id] = &node;
+    allNodes_.add(id);
+    subjectIndex_[node.getSubject()].add(id);
+    authorIndex_[node.getAuthor()].add(id);
+    courseIndex_[node.getCourse()].add(id);
+    if (node.getCommunity() >= 0) {
+        communityIndex_[node.getCommunity()].add(id);
+    }
+    if (node.hasDate()) {
+        dateIndex_.emplace(node.getDateEpoch(), id);
+    }
+
+    std::vector<TagId> tagIds;
+    for (const auto& tag : node.getTags()) {
+        tagIds.push_back(tags_.intern(tag));
+    }
+    std::sort(tagIds.begin(), tagIds.end());
+    tagIds.erase(std::unique(tagIds.begin(), tagIds.end()), tagIds.end());
+    if (tagPostings_.size() < tags_.size()) {
+        tagPostings_.resize(tags_.size());
+    }
+    for (TagId tag : tagIds) {
+        tagPostings_[tag].add(id);
+        tags_.addUsage(tag);
+    }
+    tagCooccurrence_.addSet(tagIds);
+    node.setTagIds(std::move(tagIds));
+    touchTagRow(id);
+    ++tagGeneration_;
+
+    maxNodeId_ = std::max(maxNodeId_, id);
+    for (int link : node.getLinkedNodes()) {
+        incoming_[link].push_back(node.getId());
+        if (nodeById(static_cast<uint32_t>(link))) {
+            linkComponents(node.getId(), link);
+        }
+    }
+    ++linkGeneration_;
+}
+
+void GraphDB::unindexNode(const Node& node)
+{
+    uint32_t id = static_cast<uint32_t>(node.getId());
+
+    auto drop = [id](auto& index, const auto& value) {
+        auto it = index.find(value);
+        if (it != index.end()) {
+            it->second.remove(id);
+            if (it->second.empty()) {
+                index.erase(it);
+            }
+        }
+    };
+
+    byId_[id] = nullptr;
+    allNodes_.remove(id);
+    drop(subjectIndex_, node.getSubject());
+    drop(authorIndex_, node.getAuthor());
+    drop(courseIndex_, node.getCourse());
+    drop(communityIndex_, node.getCommunity());
+    if (node.hasDate()) {
+        dateIndex_.erase({node.getDateEpoch(), id});
+    }
+    for (TagId tag : node.getTagIds()) {
+        tagPostings_[tag].remove(id);
+        tags_.removeUsage(tag);
+    }
+    tagCooccurrence_.removeSet(node.getTagIds());
+    touchTagRow(id);
+    for (int link : node.getLinkedNodes()) {
+        dropIncoming(link, node.getId());
+    }
+    ++tagGeneration_;
+    ++linkGeneration_;
+}
+
+void GraphDB::dropIncoming(int target, int source)
+{
+    auto it = incoming_.find(target);
+    if (it == incoming_.end()) {
+        return;
+    }
+    auto& sources = it->second;
+    auto pos = std::find(sources.begin(), sources.end(), source);
+    if (pos != sources.end()) {
+        *pos = sources.back();
+        sources.pop_back();
+    }
+    if (sources.empty()) {
+        incoming_.erase(it);
+    }
+}
+
+bool GraphDB::appendLink(Node& node, int to)
+{
+    const auto& linked = node.getLinkedNodes();
+    if (std::find(linked.begin(), linked.end(), to) != linked.end()) {
+        return false;
+    }
+    std::vector<int> updated = linked;
+    updated.push_back(to);
+    node.setLinkedNodes(updated);
+    incoming_[to].push_back(node.getId());
+    return true;
+}
+
+bool GraphDB::dropLink(Node& node, int to)
+{
+    std::vector<int> linked = node.getLinkedNodes();
+    size_t before = linked.size();
+    linked.erase(std::remove(linked.begin(), linked.end(), to), linked.end());
+    if (linked.size() == before) {
+        return false;
+    }
+    for (size_t i = linked.size(); i < before; ++i) {
+        dropIncoming(to, node.getId());
+    }
+    node.setLinkedNodes(linked);
+    return true;
+}
+
+void GraphDB::clearIndexes()
+{
+    byId_.clear();
+    allNodes_.clear();
+    subjectIndex_.clear();
+    authorIndex_.clear();
+    courseIndex_.clear();
+    communityIndex_.clear();
+    dateIndex_.clear();
+    tagPostings_.clear();
+    tagCooccurrence_.clear();
+    incoming_.clear();
+    tags_.resetUsage();
+    tagMatrixDirty_.clear();
+    tagMatrixGeneration_ = UINT64_MAX;
+    ++tagGeneration_;
+    ++linkGeneration_;
+    componentsDirty_ = true;
+    maxNodeId_ = 0;
+}
+
+std::string GraphDB::serialize() const
+{
+    std::vector<nlohmann::json> nodes_json;
+    nodes_json.reserve(nodes.size());
+
+    for (const auto& node_pair : nodes) {
+        nodes_json.push_back(node_pair.second->to_json());
+    }
+
+    nlohmann::json j;
+    j["nodes"] = nodes_json;
+
+    return j.dump();
+}
+
+void GraphDB::loadFromJson() {
+    try {
+        std::ifstream file(DB_FILE_PATH);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open database file");
+        }
+
+        nlohmann::json j;
+        file >> j;
+
+        // Clear existing nodes
+        for (auto& pair : nodes) {
+            delete pair.second;
+        }
+        nodes.clear();
+        nodeFiles.clear();
+        clearIndexes();
+        size = 0;
+        bumpGeneration();
+
+        // Restore tag ids before nodes intern their tags
+        tags_.clear();
+        if (j.contains("tagDictionary") && j["tagDictionary"].is_array()) {
+            for (const auto& tag : j["tagDictionary"]) {
+                tags_.intern(tag.get<std::string>());
+            }
+        }
+
+        // Load nodes
+        if (j.contains("nodes") && j["nodes"].is_array()) {
+            for (const auto& nodeJson : j["nodes"]) {
+                Node* node = new Node(nodeJson);
+                std::string nodeId = std::to_string(node->getId());
+                nodes[nodeId] = node;
+                indexNode(*node);
+                size++;
+            }
+        }
+        
+        // Load file associations
+        if (j.contains("nodeFiles") && j["nodeFiles"].is_object()) {
+            for (auto it = j["nodeFiles"].begin(); it != j["nodeFiles"].end(); ++it) {
+                std::string nodeId = it.key();
+                if (it.value().is_array()) {
+                    for (const auto& filePath : it.value()) {
+                        nodeFiles[nodeId].push_back(filePath);
+                    }
+                }
+            }
+        }
+
+        // Load tag bank
+        if (j.contains("tagBank") && j["tagBank"].is_array()) {
+            for (const auto& tag : j["tagBank"]) {
+                tags_.addToBank(tag.get<std::string>());
+            }
+            ++tagBankGeneration_;
+        }
+
+        // Edge attributes; a missing sidecar leaves every link manual
+        if (std::filesystem::exists(EDGE_FILE_PATH) && !edgeStore_.load(EDGE_FILE_PATH)) {
+            std::cerr << "Ignoring unreadable edge file: " << EDGE_FILE_PATH << std::endl;
+        }
+        edgesDirty_ = false;
+
+        setSize(j.value("size", 0));
+    } catch (const nlohmann::json::parse_error& e) {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        createJson();
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading database: " << e.what() << std::endl;
+        createJson();
+    }
+}
+
+void GraphDB::createJson() {
+    nodes.clear();
+    clearIndexes();
+    tags_.clear();
+    edgeStore_.clear();
+    edgesDirty_ = true; // Replaces any stale sidecar
+    this->setSize(0);
+    bumpGeneration();
+
+    // Создаем директорию если не существует
+    std::filesystem::path dbPath(DB_FILE_PATH);
+    if (dbPath.has_parent_path()) {
+        std::filesystem::create_directories(dbPath.parent_path());
+    }
+
+    std::ofstream file(DB_FILE_PATH);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to create database file: " + DB_FILE_PATH);
+    }
+
+    nlohmann::json j;
+    j["nodes"] = nlohmann::json::array();
+    j["tagBank"] = nlohmann::json::array();
+    j["size"] = getSize();
+    file << j.dump(4);
+}
+
+void GraphDB::saveToJson() {
+    // Создаем директорию если не существует
+    std::filesystem::path dbPath(DB_FILE_PATH);
+    if (dbPath.has_parent_path()) {
+        std::filesystem::create_directories(dbPath.parent_path());
+    }
+
+    std::ofstream file(DB_FILE_PATH);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open database file for writing: " + DB_FILE_PATH);
+    }
+
+    nlohmann::json j;
+    j["size"] = size;
+    j["nodes"] = nlohmann::json::array();
+    
+    // Convert node IDs to integers for sorting
+    std::vector<std::pair<int, Node*>> sorted_nodes;
+    for (const auto& pair : nodes) {
+        try {
+            int nodeId = std::stoi(pair.first);
+            sorted_nodes.emplace_back(nodeId, pair.second);
+        } catch (const std::exception& e) {
+            // If node ID is not a number, skip sorting for this node
+            j["nodes"].push_back(pair.second->to_json());
+        }
+    }
+    
+    // Sort nodes by numeric ID
+    std::sort(sorted_nodes.begin(), sorted_nodes.end(),
+             [](const auto& a, const auto& b) {
+                  return a.first < b.first;
+              });
+
+    // Add sorted nodes to JSON
+    for (const auto& [_, node] : sorted_nodes) {
+        j["nodes"].push_back(node->to_json());
+    }
+
+    // Save file associations
+    for (const auto& [nodeId, files] : nodeFiles) {
+        j["nodeFiles"][nodeId] = files;
+    }
+
+    // Save tag bank and the id order of all known tags
+    j["tagBank"] = tags_.bank();
+    j["tagDictionary"] = tags_.names();
+
+    file << j.dump(4);
+
+    // The edge sidecar is only rewritten when link attributes changed
+    if (edgesDirty_) {
+        if (!edgeStore_.save(EDGE_FILE_PATH)) {
+            throw std::runtime_error("Failed to write edge file: " + EDGE_FILE_PATH);
+        }
+        edgesDirty_ = false;
+    }
+}
+
+std::string GraphDB::addNode(nlohmann::json& j, const std::vector<std::pair<std::string, std::string>>& files) {
+    std::string id = generateNodeId();
+    int newId = std::stoi(id);
+
+    // A reused id can still be listed by nodes that linked its previous owner
+    // (saved before deletes cleaned up after themselves): those links belonged
+    // to the old node, so they are dropped rather than handed to the new one
+    auto stale = incoming_.find(newId);
+    if (stale != incoming_.end()) {
+        std::vector<int> sources = stale->second;
+        for (int source : sources) {
+            if (Node* other = nodeById(static_cast<uint32_t>(source))) {
+                dropLink(*other, newId);
+            }
+        }
+        incoming_.erase(newId);
+        forgetEdges(newId, sources);
+    }
+
+    j["id"] = newId;          // Add the ID to the JSON object
+    j.erase("community");     // Labels only come from detectCommunities
+    Node* node = new Node(j);  // Use the JSON constructor
+    nodes[id] = node;
+    if (static_cast<uint32_t>(newId) <= maxNodeId_) {
+        componentsDirty_ = true; // Reused id: components may still join it to old neighbors
+    }
+    indexNode(*node);
+    // Mirror the links it lists on the other ends
+    for (int link : std::vector<int>(node->getLinkedNodes())) {
+        Node* other = link != newId ? nodeById(static_cast<uint32_t>(link)) : nullptr;
+        if (other) {
+            appendLink(*other, newId);
+        }
+    }
+    size++;
+    bumpGeneration();
+    syncLinkCheck();
+    syncRanks();
+    syncLayout();
+    syncCommunities();
+    
+    // Add files to the node
+    for (const auto& file : files) {
         addFileToNode(id, file.first, file.second);
     }
     
@@ -405,10 +1362,33 @@ bool GraphDB::deleteNode(const std::string& id) {
     }
     
     // Delete the node
-    delete nodeIt->second;
+    unindexNode(*nodeIt->second);
+    componentsDirty_ = true;
+    Node* node = nodeIt->second;
     nodes.erase(nodeIt);
+
+    // Only the nodes that list this one are touched: O(degree), no scan
+    std::vector<int> neighbors = node->getLinkedNodes();
+    auto in = incoming_.find(node->getId());
+    if (in != incoming_.end()) {
+        std::vector<int> sources = in->second;
+        for (int source : sources) {
+            if (Node* other = nodeById(static_cast<uint32_t>(source))) {
+                dropLink(*other, node->getId());
+            }
+        }
+        neighbors.insert(neighbors.end(), sources.begin(), sources.end());
+        incoming_.erase(node->getId());
+    }
+    forgetEdges(node->getId(), neighbors); // Node already gone from the map
+    delete node;
     
     size--;
+    bumpGeneration();
+    syncLinkCheck();
+    syncRanks();
+    syncLayout();
+    syncCommunities();
     saveToJson();
     return true;
 }
@@ -424,6 +1404,7 @@ std::string GraphDB::addFileToNode(const std::string& nodeId, const std::string&
     // Update node's storage path if this is the first file
     if (nodeFiles[nodeId].size() == 1) {
         nodes[nodeId]->setStoragePath(filePath);
+        bumpGeneration();
     }
     
     saveToJson();
@@ -441,6 +1422,7 @@ std::string GraphDB::addFileToNode(const std::string& nodeId, const std::string&
     // Update node's storage path if this is the first file
     if (nodeFiles[nodeId].size() == 1) {
         nodes[nodeId]->setStoragePath(filePath);
+        bumpGeneration();
     }
     
     saveToJson();
@@ -468,6 +1450,7 @@ bool GraphDB::removeFileFromNode(const std::string& nodeId, const std::string& f
     // If this was the last file, clear the storage path
     if (files.empty()) {
         nodes[nodeId]->setStoragePath("");
+        bumpGeneration();
     }
     
     saveToJson();
@@ -492,26 +1475,47 @@ std::string GraphDB::generateNodeId() {
 
 // Tag bank operations
 void GraphDB::setTagBank(const std::vector<std::string>& tags) {
-    tagBank_ = tags;
+    tags_.clearBank();
+    for (const auto& tag : tags) {
+        tags_.addToBank(tag);
+    }
+    ++tagBankGeneration_;
     saveToJson();
 }
 
 void GraphDB::addToTagBank(const std::vector<std::string>& newTags) {
+    bool added = false;
     for (const auto& tag : newTags) {
-        if (std::find(tagBank_.begin(), tagBank_.end(), tag) == tagBank_.end()) {
-            tagBank_.push_back(tag);
-        }
+        added = tags_.addToBank(tag) || added;
     }
-    saveToJson();
+    if (added) {
+        ++tagBankGeneration_;
+        saveToJson();
+    }
+}
+
+std::vector<TagCompleter::Entry> GraphDB::completeTags(const std::string& prefix, size_t limit, size_t* matches) const {
+    const TagCompleter& completer = tagCompleter();
+    if (matches) {
+        auto [begin, end] = completer.range(prefix);
+        *matches = end - begin;
+    }
+
+    std::vector<TagCompleter::Entry> result;
+    for (const auto* entry : completer.complete(prefix, limit)) {
+        result.push_back(*entry);
+    }
+    return result;
 }
 
 std::vector<int> GraphDB::findNodesByTag(const std::string& tag) const {
     std::vector<int> result;
-    for (const auto& [id, node] : nodes) {
-        auto tags = node->getTags();
-        if (std::find(tags.begin(), tags.end(), tag) != tags.end()) {
-            result.push_back(node->getId());
-        }
+    TagId tagId = tags_.find(tag);
+    if (tagId >= tagPostings_.size()) {
+        return result;
+    }
+    for (uint32_t id : tagPostings_[tagId].toVector()) {
+        result.push_back(static_cast<int>(id));
     }
     return result;
 }
@@ -525,23 +1529,21 @@ std::vector<int> GraphDB::findNodesWithSharedTags(int nodeId) const {
         return result;
     }
 
-    auto nodeTags = it->second->getTags();
+    const auto& nodeTags = it->second->getTagIds();
     if (nodeTags.empty()) {
         return result;
     }
 
-    for (const auto& [otherId, otherNode] : nodes) {
-        if (otherNode->getId() == nodeId) continue;
-
-        auto otherTags = otherNode->getTags();
-        for (const auto& tag : nodeTags) {
-            if (std::find(otherTags.begin(), otherTags.end(), tag) != otherTags.end()) {
-                result.push_back(otherNode->getId());
-                break;  // Found at least one shared tag
-            }
-        }
+    // Union of the postings of every tag on this node
+    RoaringBitmap shared;
+    for (TagId tag : nodeTags) {
+        shared |= tagPostings_[tag];
     }
+    shared.remove(static_cast<uint32_t>(nodeId));
 
+    for (uint32_t id : shared.toVector()) {
+        result.push_back(static_cast<int>(id));
+    }
     return result;
 }
 
@@ -550,54 +1552,954 @@ float GraphDB::calculateJaccardSimilarity(const std::vector<std::string>& tags1,
         return 0.0f;
     }
 
-    // Calculate intersection
-    std::vector<std::string> intersection;
-    for (const auto& tag : tags1) {
-        if (std::find(tags2.begin(), tags2.end(), tag) != tags2.end()) {
-            intersection.push_back(tag);
+    // Sorted unique copies, then one merge pass
+    std::vector<std::string> a = tags1, b = tags2;
+    std::sort(a.begin(), a.end());
+    a.erase(std::unique(a.begin(), a.end()), a.end());
+    std::sort(b.begin(), b.end());
+    b.erase(std::unique(b.begin(), b.end()), b.end());
+
+    size_t common = 0;
+    for (size_t i = 0, j = 0; i < a.size() && j < b.size();) {
+        int cmp = a[i].compare(b[j]);
+        if (cmp < 0) ++i;
+        else if (cmp > 0) ++j;
+        else { ++common; ++i; ++j; }
+    }
+
+    return static_cast<float>(common) / static_cast<float>(a.size() + b.size() - common);
+}
+
+std::vector<int> GraphDB::findNodesWithJaccardSimilarity(int nodeId, float threshold) const {
+    std::vector<int> result;
+    for (const auto& [id, score] : scoreTagSimilarity(nodeId, threshold)) {
+        result.push_back(id);
+    }
+    return result;
+}
+
+std::vector<std::pair<int, float>> GraphDB::scoreTagSimilarity(int nodeId, float threshold) const {
+    std::vector<std::pair<int, float>> result;
+
+    auto it = nodes.find(std::to_string(nodeId));
+    if (it == nodes.end() || it->second->getTagIds().empty()) {
+        return result;
+    }
+
+    const TagMatrix& matrix = tagMatrix();
+    std::vector<float> scores;
+    matrix.scoreAll(it->second->getTagIds(), scores);
+
+    for (size_t row = 0; row < scores.size(); ++row) {
+        int otherId = static_cast<int>(matrix.nodeId(row));
+        if (otherId != nodeId && scores[row] > 0.0f && scores[row] >= threshold) {
+            result.emplace_back(otherId, scores[row]);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    return result;
+}
+
+float GraphDB::tagSimilarity(int nodeId1, int nodeId2) const {
+    const TagMatrix& matrix = tagMatrix();
+    int a = matrix.rowOf(static_cast<uint32_t>(nodeId1));
+    int b = matrix.rowOf(static_cast<uint32_t>(nodeId2));
+    if (a < 0 || b < 0) {
+        return 0.0f;
+    }
+    return matrix.score(static_cast<size_t>(a), static_cast<size_t>(b));
+}
+
+int GraphDB::addLinks(const std::vector<std::pair<int, int>>& edges) {
+    std::vector<WeightedLink> links;
+    links.reserve(edges.size());
+    for (const auto& [id1, id2] : edges) {
+        links.push_back({id1, id2, 1.0f});
+    }
+    return addLinks(links, EDGE_MANUAL);
+}
+
+int GraphDB::addLinks(const std::vector<WeightedLink>& links, EdgeType type) {
+    bool changed = false;
+    int created = insertLinks(links, type, changed);
+    if (changed) {
+        ++linkGeneration_;
+        bumpGeneration();
+        syncLinkCheck();
+        syncRanks();
+        syncLayout();
+        syncCommunities();
+        saveToJson();
+    }
+    return created;
+}
+
+std::pair<int, int> GraphDB::replaceLinks(const std::vector<WeightedLink>& links, EdgeType type) {
+    std::set<std::pair<uint32_t, uint32_t>> keep;
+    for (const auto& l : links) {
+        keep.emplace(static_cast<uint32_t>(std::min(l.from, l.to)), static_cast<uint32_t>(std::max(l.from, l.to)));
+    }
+
+    // Links that only `type` vouched for and that are not in the new set go away
+    int removed = 0;
+    bool changed = false;
+    for (const auto& [a, b] : edgeStore_.withType(type)) {
+        if (keep.count({a, b})) continue;
+        edgesDirty_ = true;
+        changed = true;
+        if (!edgeStore_.removeType(a, b, type)) {
+            continue; // Still linked through another source
+        }
+        for (auto [from, to] : {std::make_pair(a, b), std::make_pair(b, a)}) {
+            if (Node* node = nodeById(from)) {
+                dropLink(*node, static_cast<int>(to));
+            }
+        }
+        removed++;
+    }
+    if (removed > 0) {
+        componentsDirty_ = true;
+    }
+
+    int created = insertLinks(links, type, changed);
+    if (changed) {
+        ++linkGeneration_;
+        bumpGeneration();
+        syncLinkCheck();
+        syncRanks();
+        syncLayout();
+        syncCommunities();
+        saveToJson();
+    }
+    return {created, removed};
+}
+
+int GraphDB::insertLinks(const std::vector<WeightedLink>& links, EdgeType type, bool& changed) {
+    uint32_t now = static_cast<uint32_t>(std::time(nullptr));
+    int created = 0;
+    for (const auto& [id1, id2, weight] : links) {
+        if (id1 == id2) continue;
+        Node* node1 = nodeById(static_cast<uint32_t>(id1));
+        Node* node2 = nodeById(static_cast<uint32_t>(id2));
+        if (!node1 || !node2) continue;
+
+        bool forward = appendLink(*node1, id2);
+        bool backward = appendLink(*node2, id1);
+        // Links without a record read as manual, weight 1; one only gets a
+        // record once a second source has to be told apart from that
+        uint32_t a = static_cast<uint32_t>(id1);
+        uint32_t b = static_cast<uint32_t>(id2);
+        EdgeInfo existing;
+        bool recorded = edgeStore_.find(a, b, existing);
+        if (type != EDGE_MANUAL || recorded) {
+            if (!recorded && !forward && !backward) {
+                edgeStore_.upsert(a, b, EDGE_MANUAL, 1.0f, 0);
+            }
+            if (edgeStore_.upsert(a, b, type, weight, now)) {
+                edgesDirty_ = true;
+                changed = true;
+            }
+        }
+        if (forward || backward) {
+            linkComponents(id1, id2);
+            created++;
+            changed = true;
+        }
+    }
+    return created;
+}
+
+EdgeInfo GraphDB::getEdge(int nodeId1, int nodeId2) const {
+    return edgeStore_.get(static_cast<uint32_t>(nodeId1), static_cast<uint32_t>(nodeId2));
+}
+
+void GraphDB::forgetEdges(int nodeId, const std::vector<int>& links) {
+    // The link survives while either side still lists the other
+    auto lists = [this](int from, int to) {
+        const Node* node = nodeById(static_cast<uint32_t>(from));
+        if (!node) return false;
+        const auto& linked = node->getLinkedNodes();
+        return std::find(linked.begin(), linked.end(), to) != linked.end();
+    };
+    for (int link : links) {
+        if (link < 0 || lists(nodeId, link) || lists(link, nodeId)) continue;
+        if (edgeStore_.erase(static_cast<uint32_t>(nodeId), static_cast<uint32_t>(link))) {
+            edgesDirty_ = true;
+        }
+    }
+}
+
+void GraphDB::checkLinks(bool wait) {
+    if (!linkCheckJob_) {
+        startLinkCheck();
+    }
+    if (wait ? installLinkCheck() : syncLinkCheck()) {
+        saveToJson();
+    }
+}
+
+nlohmann::json GraphDB::getLinkCheckStatus() {
+    if (syncLinkCheck()) {
+        saveToJson();
+    }
+    nlohmann::json status = linkCheckReport_;
+    status["running"] = static_cast<bool>(linkCheckJob_);
+    status["linkChangesSinceCheck"] = linkGeneration_ - linkCheckGeneration_;
+    return status;
+}
+
+bool GraphDB::syncLinkCheck() {
+    if (linkCheckJob_) {
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock(linkCheckJob_->mutex);
+            done = linkCheckJob_->done;
+        }
+        return done && installLinkCheck();
+    }
+    if (linkGeneration_ - linkCheckGeneration_ >= LINK_CHECK_INTERVAL) {
+        startLinkCheck();
+    }
+    return false;
+}
+
+void GraphDB::startLinkCheck() {
+    // The sweep reads copies; the live lists keep changing meanwhile
+    std::vector<std::pair<int, std::vector<int>>> lists;
+    lists.reserve(nodes.size());
+    for (const auto& [_, node] : nodes) {
+        lists.emplace_back(node->getId(), node->getLinkedNodes());
+    }
+    auto records = edgeStore_.withType(EDGE_ALL_TYPES);
+
+    auto job = std::make_shared<LinkCheckJob>();
+    linkCheckJob_ = job;
+    linkCheckGeneration_ = linkGeneration_;
+    linkCheckThread_ = std::thread([job, lists = std::move(lists), records = std::move(records)]() mutable {
+        ThreadPool::enterBackground();
+        auto start = std::chrono::steady_clock::now();
+        std::sort(lists.begin(), lists.end());
+        for (auto& [_, linked] : lists) {
+            std::sort(linked.begin(), linked.end());
+        }
+        auto find = [&lists](int id) -> const std::vector<int>* {
+            auto it = std::lower_bound(lists.begin(), lists.end(), id,
+                                       [](const auto& entry, int key) { return entry.first < key; });
+            return it != lists.end() && it->first == id ? &it->second : nullptr;
+        };
+        auto listed = [&find](int from, int to) {
+            const std::vector<int>* linked = find(from);
+            return linked && std::binary_search(linked->begin(), linked->end(), to);
+        };
+
+        std::vector<std::pair<int, int>> dangling, asymmetric;
+        std::vector<std::pair<uint32_t, uint32_t>> orphans;
+        size_t links = 0;
+        for (const auto& [id, linked] : lists) {
+            links += linked.size();
+            for (int to : linked) {
+                if (to == id) continue;
+                const std::vector<int>* back = find(to);
+                if (!back) {
+                    dangling.emplace_back(id, to);
+                } else if (!std::binary_search(back->begin(), back->end(), id)) {
+                    asymmetric.emplace_back(id, to);
+                }
+            }
+        }
+        for (const auto& [a, b] : records) {
+            if (!listed(static_cast<int>(a), static_cast<int>(b)) && !listed(static_cast<int>(b), static_cast<int>(a))) {
+                orphans.emplace_back(a, b);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->dangling = std::move(dangling);
+        job->asymmetric = std::move(asymmetric);
+        job->orphanRecords = std::move(orphans);
+        job->nodes = lists.size();
+        job->links = links;
+        job->elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        job->done = true;
+    });
+}
+
+bool GraphDB::installLinkCheck() {
+    linkCheckThread_.join();
+    std::shared_ptr<LinkCheckJob> job = std::move(linkCheckJob_);
+    linkCheckJob_.reset();
+
+    // Findings come from a snapshot: each one is re-checked before it is repaired
+    size_t repaired = 0;
+    std::vector<int> forgotten;
+    for (const auto& [from, to] : job->dangling) {
+        Node* node = nodeById(static_cast<uint32_t>(from));
+        if (node && !nodeById(static_cast<uint32_t>(to)) && dropLink(*node, to)) {
+            forgetEdges(from, {to});
+            repaired++;
+        }
+    }
+    for (const auto& [from, to] : job->asymmetric) {
+        Node* node = nodeById(static_cast<uint32_t>(from));
+        Node* other = nodeById(static_cast<uint32_t>(to));
+        if (!node || !other) continue;
+        const auto& linked = node->getLinkedNodes();
+        if (std::find(linked.begin(), linked.end(), to) != linked.end() && appendLink(*other, from)) {
+            repaired++;
+        }
+    }
+    for (const auto& [a, b] : job->orphanRecords) {
+        size_t before = edgeStore_.size();
+        forgetEdges(static_cast<int>(a), {static_cast<int>(b)});
+        repaired += before - edgeStore_.size();
+    }
+
+    linkCheckReport_ = {
+        {"nodes", job->nodes},
+        {"links", job->links},
+        {"dangling", job->dangling.size()},
+        {"asymmetric", job->asymmetric.size()},
+        {"orphanRecords", job->orphanRecords.size()},
+        {"repaired", repaired},
+        {"elapsedMs", job->elapsedMs}
+    };
+    if (repaired > 0) {
+        std::cout << "Link check: " << job->dangling.size() << " dangling, " << job->asymmetric.size()
+                  << " one-way links, " << job->orphanRecords.size() << " orphan edge records; repaired "
+                  << repaired << std::endl;
+        // Lists changed but the undirected graph did not: no new link generation
+        bumpGeneration();
+    }
+    return repaired > 0;
+}
+
+void GraphDB::linkComponents(int nodeId1, int nodeId2) {
+    if (!componentsDirty_ && components_.unite(static_cast<uint32_t>(nodeId1), static_cast<uint32_t>(nodeId2))) {
+        componentMerges_++;
+    }
+}
+
+UnionFind& GraphDB::components() const {
+    if (componentsDirty_) {
+        // Labels come from the parallel kernel; the union-find then only
+        // needs one union per non-root vertex
+        const CsrGraph& graph = getLinkGraph();
+        std::vector<uint32_t> labels = ConnectedComponents::fromGraph(graph);
+        components_.reset(static_cast<size_t>(maxNodeId_) + 1);
+        componentMerges_ = 0;
+        for (uint32_t v = 0; v < labels.size(); ++v) {
+            if (labels[v] != v && components_.unite(graph.nodeId(labels[v]), graph.nodeId(v))) {
+                componentMerges_++;
+            }
+        }
+        componentsDirty_ = false;
+    }
+    return components_;
+}
+
+int GraphDB::componentOf(int nodeId) const {
+    if (nodeId < 0 || !nodeById(static_cast<uint32_t>(nodeId))) {
+        return -1;
+    }
+    UnionFind& uf = components();
+    uf.grow(static_cast<size_t>(nodeId) + 1);
+    return static_cast<int>(uf.find(static_cast<uint32_t>(nodeId)));
+}
+
+size_t GraphDB::componentSize(int nodeId) const {
+    if (nodeId < 0 || !nodeById(static_cast<uint32_t>(nodeId))) {
+        return 0;
+    }
+    UnionFind& uf = components();
+    uf.grow(static_cast<size_t>(nodeId) + 1);
+    return uf.setSize(static_cast<uint32_t>(nodeId));
+}
+
+size_t GraphDB::componentCount() const {
+    components();
+    return static_cast<size_t>(allNodes_.cardinality()) - componentMerges_;
+}
+
+void GraphDB::JobRetry::failed(const std::string& message) {
+    error = message.empty() ? "unknown error" : message;
+    size_t delay = JOB_RETRY_MIN_MS << std::min(failures, 16u);
+    failures++;
+    notBefore = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::min(delay, JOB_RETRY_MAX_MS));
+}
+
+void GraphDB::JobRetry::succeeded() {
+    error.clear();
+    failures = 0;
+}
+
+void GraphDB::JobRetry::report(nlohmann::json& status) const {
+    if (failures > 0) {
+        status["error"] = error;
+        status["failures"] = failures;
+    }
+}
+
+void GraphDB::scheduleRankRefresh() {
+    rankEnabled_ = true;
+    syncRanks();
+}
+
+void GraphDB::prepareRanks() const {
+    rankEnabled_ = true;
+    syncRanks(); // Until the first column lands every rank is 0, so rank order is id order
+}
+
+void GraphDB::syncRanks() const {
+    if (rankJob_) {
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock(rankJob_->mutex);
+            done = rankJob_->done;
+        }
+        if (!done) {
+            return; // Links that changed meanwhile are picked up by the next job
+        }
+        installRankJob();
+    }
+    if (rankEnabled_ && rankLinkGeneration_ != linkGeneration_ && rankRetry_.due()) {
+        startRankJob();
+    }
+}
+
+void GraphDB::startRankJob() const {
+    // The job owns a copy of the snapshot: the live one is rebuilt on this thread
+    CsrGraph graph = getLinkGraph();
+    std::vector<double> warmStart;
+    if (!rankColumn_.empty()) {
+        warmStart.resize(graph.vertexCount());
+        for (uint32_t v = 0; v < graph.vertexCount(); ++v) {
+            uint32_t id = graph.nodeId(v);
+            warmStart[v] = id < rankColumn_.size() ? rankColumn_[id] : 0.0;
         }
     }
 
-    // Calculate union (unique elements from both)
-    std::vector<std::string> unionTags = tags1;
-    for (const auto& tag : tags2) {
-        if (std::find(unionTags.begin(), unionTags.end(), tag) == unionTags.end()) {
-            unionTags.push_back(tag);
+    auto job = std::make_shared<RankJob>();
+    job->linkGeneration = linkGeneration_;
+    size_t columnSize = static_cast<size_t>(maxNodeId_) + 1;
+    rankJob_ = job;
+    rankThread_ = std::thread([job, graph = std::move(graph), warmStart = std::move(warmStart), columnSize]() {
+        ThreadPool::enterBackground();
+        auto start = std::chrono::steady_clock::now();
+        std::vector<float> column;
+        PageRank::Result result;
+        std::string error;
+        try {
+            result = PageRank::compute(graph, PageRank::Options{}, warmStart);
+            column.assign(columnSize, 0.0f);
+            for (uint32_t v = 0; v < graph.vertexCount(); ++v) {
+                column[graph.nodeId(v)] = static_cast<float>(result.scores[v]);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "PageRank job failed: " << e.what() << std::endl;
+            error = e.what();
         }
+
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->column = std::move(column);
+        job->iterations = result.iterations;
+        job->residual = result.residual;
+        job->elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        job->error = std::move(error);
+        job->done = true;
+    });
+}
+
+void GraphDB::installRankJob() const {
+    rankThread_.join();
+    std::shared_ptr<RankJob> job = std::move(rankJob_);
+    rankJob_.reset();
+
+    if (!job->error.empty()) {
+        rankRetry_.failed(job->error); // The last good column stays; retried after a delay
+        return;
     }
+    rankRetry_.succeeded();
+    rankLinkGeneration_ = job->linkGeneration;
+    rankColumn_ = std::move(job->column);
+    rankVersion_++;
+    rankStats_ = {
+        {"iterations", job->iterations},
+        {"residual", job->residual},
+        {"elapsedMs", job->elapsedMs},
+        {"warmStart", rankVersion_ > 1}
+    };
+}
 
-    if (unionTags.empty()) {
+float GraphDB::getRank(int nodeId) const {
+    syncRanks();
+    if (nodeId < 0 || static_cast<size_t>(nodeId) >= rankColumn_.size()) {
         return 0.0f;
     }
+    return rankColumn_[static_cast<size_t>(nodeId)];
+}
 
-    return static_cast<float>(intersection.size()) / static_cast<float>(unionTags.size());
+nlohmann::json GraphDB::getRankStatus() const {
+    syncRanks();
+    nlohmann::json status = rankStats_;
+    status["version"] = rankVersion_;
+    status["running"] = static_cast<bool>(rankJob_);
+    status["stale"] = rankLinkGeneration_ != linkGeneration_;
+    rankRetry_.report(status);
+    return status;
 }
 
-std::vector<int> GraphDB::findNodesWithJaccardSimilarity(int nodeId, float threshold) const {
-    std::vector<int> result;
-    std::string nodeIdStr = std::to_string(nodeId);
+std::vector<std::pair<int, double>> GraphDB::topRanked(size_t limit) const {
+    prepareRanks();
+    std::vector<std::pair<int, double>> result;
+    if (rankVersion_ == 0) {
+        return result; // Nothing computed yet
+    }
+    allNodes_.forEach([&](uint32_t id) {
+        result.emplace_back(static_cast<int>(id), id < rankColumn_.size() ? rankColumn_[id] : 0.0f);
+        return true;
+    });
+
+    auto better = [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    };
+    if (limit < result.size()) {
+        std::partial_sort(result.begin(), result.begin() + limit, result.end(), better);
+        result.resize(limit);
+    } else {
+        std::sort(result.begin(), result.end(), better);
+    }
+    return result;
+}
 
-    auto it = nodes.find(nodeIdStr);
-    if (it == nodes.end()) {
-        return result;
+std::vector<std::pair<int, double>> GraphDB::personalizedRank(int nodeId, size_t limit, const EdgeFilter& filter) const {
+    const CsrGraph& graph = getLinkGraph();
+    int source = nodeId >= 0 ? graph.vertexOf(static_cast<uint32_t>(nodeId)) : -1;
+    if (source < 0) {
+        return {};
     }
 
-    auto nodeTags = it->second->getTags();
-    if (nodeTags.empty()) {
-        return result;
+    PageRank::Options options;
+    options.source = source;
+    options.filter = filter;
+    PageRank::Result ranks = PageRank::compute(graph, options);
+
+    // Only vertices the walk can reach score above zero
+    std::vector<std::pair<int, double>> result;
+    for (uint32_t v = 0; v < graph.vertexCount(); ++v) {
+        if (static_cast<int>(v) != source && ranks.scores[v] > 0) {
+            result.emplace_back(static_cast<int>(graph.nodeId(v)), ranks.scores[v]);
+        }
+    }
+    auto better = [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    };
+    if (limit < result.size()) {
+        std::partial_sort(result.begin(), result.begin() + limit, result.end(), better);
+        result.resize(limit);
+    } else {
+        std::sort(result.begin(), result.end(), better);
     }
+    return result;
+}
 
-    for (const auto& [otherId, otherNode] : nodes) {
-        if (otherNode->getId() == nodeId) continue;
+nlohmann::json GraphDB::detectCommunities(const Louvain::Options& options) {
+    syncCommunities();
+    if (communityJob_) {
+        return getCommunityStatus(); // One run at a time
+    }
 
-        auto otherTags = otherNode->getTags();
-        if (otherTags.empty()) continue;
+    // The job owns a copy of the snapshot: the live one is rebuilt on this thread
+    CsrGraph graph = getLinkGraph();
+    auto job = std::make_shared<CommunityJob>();
+    job->linkGeneration = linkGeneration_;
+    job->resolution = options.resolution;
+    communityJob_ = job;
+    communityThread_ = std::thread([job, graph = std::move(graph), options]() {
+        ThreadPool::enterBackground();
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::pair<uint32_t, int>> labels;
+        Louvain::Result result;
+        std::string error;
+        try {
+            result = Louvain::run(graph, options);
+            // Label each community by its smallest node id: vertices ascend by node id
+            std::vector<int> labelOf(result.communities, -1);
+            labels.reserve(graph.vertexCount());
+            for (uint32_t v = 0; v < graph.vertexCount(); ++v) {
+                int& label = labelOf[result.community[v]];
+                if (label < 0) {
+                    label = static_cast<int>(graph.nodeId(v));
+                }
+                labels.emplace_back(graph.nodeId(v), label);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Community detection failed: " << e.what() << std::endl;
+            error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->labels = std::move(labels);
+        job->communities = result.communities;
+        job->modularity = result.modularity;
+        job->levels = result.levels;
+        job->sweeps = result.sweeps;
+        job->elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        job->error = std::move(error);
+        job->done = true;
+    });
+    return getCommunityStatus();
+}
 
-        float similarity = calculateJaccardSimilarity(nodeTags, otherTags);
-        if (similarity >= threshold) {
-            result.push_back(otherNode->getId());
+void GraphDB::syncCommunities() {
+    if (!communityJob_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(communityJob_->mutex);
+        if (!communityJob_->done) {
+            return;
         }
     }
+    installCommunityJob();
+}
+
+void GraphDB::installCommunityJob() {
+    communityThread_.join();
+    std::shared_ptr<CommunityJob> job = std::move(communityJob_);
+    communityJob_.reset();
 
+    if (!job->error.empty()) {
+        communityStats_["error"] = job->error; // Labels of the last good run stay
+        return;
+    }
+    size_t changed = 0;
+    for (const auto& [id, label] : job->labels) {
+        Node* node = nodeById(id);
+        if (node && node->getCommunity() != label) { // Deleted while the job ran otherwise
+            node->setCommunity(label);
+            changed++;
+        }
+    }
+    communityIndex_.clear();
+    allNodes_.forEach([&](uint32_t id) {
+        int label = nodeById(id)->getCommunity();
+        if (label >= 0) {
+            communityIndex_[label].add(id);
+        }
+        return true;
+    });
+    communityLinkGeneration_ = job->linkGeneration;
+
+    communityStats_ = {
+        {"communities", job->communities},
+        {"modularity", job->modularity},
+        {"levels", job->levels},
+        {"sweeps", job->sweeps},
+        {"resolution", job->resolution},
+        {"nodesChanged", changed},
+        {"elapsedMs", job->elapsedMs}
+    };
+    if (changed > 0) {
+        bumpGeneration();
+        saveToJson();
+    }
+}
+
+nlohmann::json GraphDB::getCommunityStatus() {
+    syncCommunities();
+    nlohmann::json status = communityStats_;
+    status["labeled"] = communityIndex_.size();
+    status["running"] = static_cast<bool>(communityJob_);
+    status["stale"] = communityLinkGeneration_ != linkGeneration_;
+    return status;
+}
+
+nlohmann::json GraphDB::listCommunities(size_t limit, size_t tagLimit) {
+    syncCommunities();
+    std::vector<std::pair<int, uint64_t>> bySize;
+    for (const auto& [label, members] : communityIndex_) {
+        bySize.emplace_back(label, members.cardinality());
+    }
+    auto larger = [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    };
+    if (limit < bySize.size()) {
+        std::partial_sort(bySize.begin(), bySize.begin() + limit, bySize.end(), larger);
+        bySize.resize(limit);
+    } else {
+        std::sort(bySize.begin(), bySize.end(), larger);
+    }
+
+    nlohmann::json result = nlohmann::json::array();
+    for (const auto& [label, count] : bySize) {
+        std::unordered_map<TagId, uint32_t> tagCounts;
+        communityIndex_.at(label).forEach([&](uint32_t id) {
+            if (const Node* node = nodeById(id)) {
+                for (TagId tag : node->getTagIds()) tagCounts[tag]++;
+            }
+            return true;
+        });
+        std::vector<std::pair<TagId, uint32_t>> top(tagCounts.begin(), tagCounts.end());
+        size_t keep = std::min(tagLimit, top.size());
+        std::partial_sort(top.begin(), top.begin() + keep, top.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        nlohmann::json tags = nlohmann::json::array();
+        for (size_t i = 0; i < keep; ++i) {
+            tags.push_back({{"tag", tags_.name(top[i].first)}, {"count", top[i].second}});
+        }
+        result.push_back({{"id", label}, {"size", count}, {"tags", tags}});
+    }
     return result;
-}
\ No newline at end of file
+}
+
+LinkPrediction::Result GraphDB::suggestLinks(int nodeId, const LinkPrediction::Options& options) const {
+    const CsrGraph& graph = getLinkGraph();
+    int vertex = nodeId >= 0 ? graph.vertexOf(static_cast<uint32_t>(nodeId)) : -1;
+    if (vertex < 0) {
+        return {};
+    }
+    return LinkPrediction::suggest(graph, static_cast<uint32_t>(vertex), options);
+}
+
+const std::vector<std::vector<LinkPrediction::Suggestion>>& GraphDB::suggestAllLinks(
+    const LinkPrediction::Options& options, double* elapsedMs) const {
+    const CsrGraph& graph = getLinkGraph();
+    const LinkPrediction::Options& cached = linkSuggestions_.options;
+    bool fresh = linkSuggestions_.linkGeneration == linkGeneration_ &&
+                 cached.score == options.score && cached.limit == options.limit &&
+                 cached.maxPaths == options.maxPaths && cached.filter.minWeight == options.filter.minWeight &&
+                 cached.filter.types == options.filter.types;
+    if (elapsedMs) {
+        *elapsedMs = 0;
+    }
+    if (!fresh) {
+        auto start = std::chrono::steady_clock::now();
+        linkSuggestions_.byVertex = LinkPrediction::suggestAll(graph, options);
+        linkSuggestions_.options = options;
+        linkSuggestions_.linkGeneration = linkGeneration_;
+        if (elapsedMs) {
+            *elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+    return linkSuggestions_.byVertex;
+}
+
+std::shared_ptr<const LayoutSnapshot> GraphDB::getLayout() {
+    // Never joins here: the request thread serves everyone else meanwhile
+    layoutEnabled_ = true;
+    syncLayout();
+    return layout_;
+}
+
+nlohmann::json GraphDB::getLayoutStatus() {
+    syncLayout();
+    nlohmann::json status = nlohmann::json::object();
+    if (layout_) {
+        status["iterations"] = layout_->iterations;
+        status["elapsedMs"] = layout_->elapsedMs;
+        status["nodes"] = layout_->ids.size();
+    }
+    status["version"] = layout_ ? layout_->version : 0;
+    status["running"] = static_cast<bool>(layoutJob_);
+    status["stale"] = !layout_ || layout_->linkGeneration != linkGeneration_;
+    layoutRetry_.report(status);
+    return status;
+}
+
+void GraphDB::syncLayout() {
+    if (layoutJob_) {
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock(layoutJob_->mutex);
+            done = layoutJob_->done;
+        }
+        if (!done) {
+            return; // Changes made meanwhile are picked up by the next job
+        }
+        installLayoutJob();
+    }
+    if (layoutEnabled_ && layoutLinkGeneration_ != linkGeneration_ && layoutRetry_.due()) {
+        startLayoutJob();
+    }
+}
+
+void GraphDB::startLayoutJob() {
+    CsrGraph graph = getLinkGraph();
+
+    // Nodes already placed keep their position; only the new ones need settling
+    std::vector<float> x, y;
+    GraphLayout::Options options;
+    options.iterations = static_cast<int>(LAYOUT_ITERATIONS);
+    if (layout_) {
+        const float none = std::numeric_limits<float>::quiet_NaN();
+        x.assign(graph.vertexCount(), none);
+        y.assign(graph.vertexCount(), none);
+        const auto& previous = layout_->ids;
+        size_t j = 0;
+        for (uint32_t v = 0; v < graph.vertexCount(); ++v) {
+            while (j < previous.size() && previous[j] < graph.nodeId(v)) j++;
+            if (j < previous.size() && previous[j] == graph.nodeId(v)) {
+                x[v] = layout_->x[j];
+                y[v] = layout_->y[j];
+            }
+        }
+        options.iterations = static_cast<int>(LAYOUT_REFINE_ITERATIONS);
+    }
+
+    auto job = std::make_shared<LayoutJob>();
+    job->linkGeneration = linkGeneration_;
+    layoutJob_ = job;
+    layoutThread_ = std::thread([job, graph = std::move(graph), x = std::move(x), y = std::move(y), options]() mutable {
+        ThreadPool::enterBackground();
+        auto start = std::chrono::steady_clock::now();
+        auto snapshot = std::make_shared<LayoutSnapshot>();
+        std::string error;
+        try {
+            snapshot->iterations = GraphLayout::run(graph, options, x, y);
+            snapshot->ids = graph.nodeIds();
+            snapshot->x = std::move(x);
+            snapshot->y = std::move(y);
+            for (uint32_t v = 0; v < graph.vertexCount(); ++v) {
+                for (uint32_t u : graph.neighbors(v)) {
+                    if (v < u) {
+                        snapshot->edges.push_back(v);
+                        snapshot->edges.push_back(u);
+                    }
+                }
+            }
+            snapshot->linkGeneration = job->linkGeneration;
+            snapshot->elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        } catch (const std::exception& e) {
+            std::cerr << "Layout job failed: " << e.what() << std::endl;
+            snapshot.reset();
+            error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->snapshot = std::move(snapshot);
+        job->error = std::move(error);
+        job->done = true;
+    });
+}
+
+void GraphDB::installLayoutJob() {
+    layoutThread_.join();
+    std::shared_ptr<LayoutJob> job = std::move(layoutJob_);
+    layoutJob_.reset();
+
+    if (!job->snapshot) {
+        layoutRetry_.failed(job->error); // The last good layout stays; retried after a delay
+        return;
+    }
+    layoutRetry_.succeeded();
+    layoutLinkGeneration_ = job->linkGeneration;
+    job->snapshot->version = (layout_ ? layout_->version : 0) + 1;
+    layout_ = std::move(job->snapshot);
+}
+
+const CsrGraph& GraphDB::getLinkGraph() const {
+    if (linkGraphGeneration_ != linkGeneration_) {
+        std::vector<uint32_t> ids = allNodes_.toVector();
+        std::vector<const Node*> byVertex;
+        byVertex.reserve(ids.size());
+        for (uint32_t id : ids) {
+            byVertex.push_back(nodeById(id));
+        }
+        linkGraph_.build(std::move(ids), [&byVertex](size_t v) -> const std::vector<int>& {
+            return byVertex[v]->getLinkedNodes();
+        }, [this](uint32_t a, uint32_t b) {
+            return edgeStore_.get(a, b);
+        });
+        linkGraphGeneration_ = linkGeneration_;
+    }
+    return linkGraph_;
+}
+
+std::vector<TagScore> GraphDB::relatedTags(const std::string& tag, size_t limit, uint32_t minCount) const {
+    TagId id = tags_.find(tag);
+    if (id == TagDictionary::NO_TAG) {
+        return {};
+    }
+    return tagCooccurrence_.related(id, tags_, allNodes_.cardinality(), limit, minCount);
+}
+
+std::vector<TagScore> GraphDB::suggestTags(const std::vector<std::string>& tags, size_t limit, uint32_t minCount) const {
+    std::vector<TagId> context;
+    for (const auto& tag : tags) {
+        TagId id = tags_.find(tag);
+        if (id != TagDictionary::NO_TAG) {
+            context.push_back(id);
+        }
+    }
+    if (context.empty()) {
+        return {};
+    }
+    std::sort(context.begin(), context.end());
+    context.erase(std::unique(context.begin(), context.end()), context.end());
+    return tagCooccurrence_.suggest(context, tags_, allNodes_.cardinality(), limit, minCount);
+}
+
+const TagCompleter& GraphDB::tagCompleter() const {
+    std::pair<uint64_t, uint64_t> current{tagGeneration_, tagBankGeneration_};
+    if (tagCompleterGeneration_ != current) {
+        std::vector<TagCompleter::Entry> entries;
+        entries.reserve(tags_.bank().size());
+        for (const auto& tag : tags_.bank()) {
+            TagId id = tags_.find(tag);
+            entries.push_back({tag, id, tags_.usage(id)});
+        }
+        tagCompleter_.build(std::move(entries));
+        tagCompleterGeneration_ = current;
+    }
+    return tagCompleter_;
+}
+
+const TagMatrix& GraphDB::tagMatrix() const {
+    if (tagMatrixGeneration_ == tagGeneration_) {
+        return tagMatrix_;
+    }
+    if (tagMatrixGeneration_ != UINT64_MAX && !tagMatrix_.needsRebuild()) {
+        // Only the rows of nodes whose tags changed are rewritten
+        auto& dirty = tagMatrixDirty_;
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        for (uint32_t id : dirty) {
+            if (const Node* node = nodeById(id)) {
+                tagMatrix_.update(id, node->getTagIds());
+            } else {
+                tagMatrix_.remove(id);
+            }
+        }
+        dirty.clear();
+    } else {
+        std::vector<TagMatrix::Row> rows;
+        rows.reserve(nodes.size());
+        allNodes_.forEach([&](uint32_t id) {
+            if (const Node* node = nodeById(id)) {
+                rows.push_back({id, &node->getTagIds()});
+            }
+            return true;
+        });
+        tagMatrix_.build(rows, tags_.size());
+        tagMatrixDirty_.clear();
+    }
+    tagMatrixGeneration_ = tagGeneration_;
+    return tagMatrix_;
+}
+
+void GraphDB::touchTagRow(uint32_t id) {
+    if (tagMatrixGeneration_ == UINT64_MAX) {
+        return; // Not built yet: the first build reads every node
+    }
+    if (tagMatrixDirty_.size() > nodes.size()) {
+        // Replaying would cost more than building again
+        tagMatrixDirty_.clear();
+        tagMatrixGeneration_ = UINT64_MAX;
+        return;
+    }
+    tagMatrixDirty_.push_back(id);
+}
@@ -0,0 +1,282 @@
+#include "core/GraphLayout.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    const size_t LAYOUT_MORSEL = 512;
+    const int MAX_TREE_DEPTH = 24; // Closer points share a leaf
+
+    // Deterministic value in [0, 1) per (node id, salt)
+    double hashUnit(uint32_t id, uint32_t salt) {
+        uint64_t z = (static_cast<uint64_t>(id) << 32 | salt) + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        return static_cast<double>(z >> 11) * 0x1.0p-53;
+    }
+
+    // Spreads the low 16 bits of v to the even bit positions
+    uint32_t spreadBits(uint32_t v) {
+        v &= 0xffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    }
+
+    // Barnes-Hut quadtree over vertex masses; cells are stored flat, the
+    // four children of a cell consecutively. Vertices are inserted in
+    // Z-order, so nearby cells sit close in memory, and order() lets force
+    // passes visit vertices the same way: consecutive walks share cells.
+    class QuadTree
+    {
+    public:
+        void build(const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& mass) {
+            size_t n = x.size();
+            double minX = std::numeric_limits<double>::max(), minY = minX;
+            double maxX = std::numeric_limits<double>::lowest(), maxY = maxX;
+            for (size_t v = 0; v < n; ++v) {
+                minX = std::min(minX, x[v]);
+                maxX = std::max(maxX, x[v]);
+                minY = std::min(minY, y[v]);
+                maxY = std::max(maxY, y[v]);
+            }
+            double size = std::max(maxX - minX, maxY - minY) * 1.0001 + 1e-9;
+
+            keyed_.resize(n);
+            for (size_t v = 0; v < n; ++v) {
+                uint32_t qx = static_cast<uint32_t>((x[v] - minX) / size * 65535.0);
+                uint32_t qy = static_cast<uint32_t>((y[v] - minY) / size * 65535.0);
+                keyed_[v] = {spreadBits(qx) | (spreadBits(qy) << 1), static_cast<uint32_t>(v)};
+            }
+            std::sort(keyed_.begin(), keyed_.end());
+            order_.resize(n);
+
+            cells_.clear();
+            cells_.reserve(2 * n + 1);
+            cells_.push_back({minX, minY, size});
+            for (size_t i = 0; i < n; ++i) {
+                order_[i] = keyed_[i].second;
+                insert(order_[i], x, y, mass);
+            }
+            for (auto& cell : cells_) {
+                if (cell.mass > 0) {
+                    cell.cx /= cell.mass;
+                    cell.cy /= cell.mass;
+                }
+            }
+        }
+
+        const std::vector<uint32_t>& order() const { return order_; }
+
+        // Repulsion on vertex v at (px, py) from every other vertex
+        void repulse(uint32_t v, double px, double py, double mass, double strength, double theta2,
+                     std::vector<int32_t>& stack, double& fx, double& fy) const {
+            stack.clear();
+            stack.push_back(0);
+            while (!stack.empty()) {
+                const Cell& cell = cells_[stack.back()];
+                stack.pop_back();
+                if (cell.count == 0) continue;
+                double dx = px - cell.cx;
+                double dy = py - cell.cy;
+                double d2 = dx * dx + dy * dy;
+                if (cell.child < 0 || cell.size * cell.size < theta2 * d2) {
+                    if ((cell.child < 0 && cell.body == v && cell.count == 1) || d2 < 1e-12) continue;
+                    double f = strength * mass * cell.mass / d2;
+                    fx += dx * f;
+                    fy += dy * f;
+                } else {
+                    for (int32_t c = cell.child; c < cell.child + 4; ++c) {
+                        if (cells_[c].count > 0) stack.push_back(c);
+                    }
+                }
+            }
+        }
+
+    private:
+        struct Cell {
+            double x0, y0, size;
+            double cx = 0, cy = 0, mass = 0; // Mass-weighted sums until build() normalizes
+            uint32_t count = 0;
+            int32_t child = -1;              // First of four children, -1 for a leaf
+            uint32_t body = 0;               // Leaf: first vertex stored
+        };
+        std::vector<Cell> cells_;
+        std::vector<std::pair<uint32_t, uint32_t>> keyed_; // (Z-order key, vertex)
+        std::vector<uint32_t> order_;
+
+        int32_t quadrant(const Cell& cell, double px, double py) const {
+            double half = cell.size / 2;
+            return (px >= cell.x0 + half ? 1 : 0) + (py >= cell.y0 + half ? 2 : 0);
+        }
+
+        void add(Cell& cell, uint32_t v, const std::vector<double>& x, const std::vector<double>& y,
+                 const std::vector<double>& mass) {
+            cell.cx += x[v] * mass[v];
+            cell.cy += y[v] * mass[v];
+            cell.mass += mass[v];
+            cell.count++;
+        }
+
+        void insert(uint32_t v, const std::vector<double>& x, const std::vector<double>& y,
+                    const std::vector<double>& mass) {
+            int32_t index = 0;
+            for (int depth = 0;; ++depth) {
+                if (cells_[index].child < 0) {
+                    if (cells_[index].count == 0) {
+                        cells_[index].body = v;
+                        add(cells_[index], v, x, y, mass);
+                        return;
+                    }
+                    if (depth >= MAX_TREE_DEPTH) {
+                        add(cells_[index], v, x, y, mass);
+                        return;
+                    }
+                    // Split the leaf and move its vertex down (indices: cells_ may grow)
+                    int32_t first = static_cast<int32_t>(cells_.size());
+                    double half = cells_[index].size / 2;
+                    for (int32_t c = 0; c < 4; ++c) {
+                        cells_.push_back({cells_[index].x0 + (c & 1 ? half : 0), cells_[index].y0 + (c & 2 ? half : 0), half});
+                    }
+                    cells_[index].child = first;
+                    uint32_t old = cells_[index].body;
+                    Cell& target = cells_[first + quadrant(cells_[index], x[old], y[old])];
+                    target.body = old;
+                    add(target, old, x, y, mass);
+                }
+                add(cells_[index], v, x, y, mass);
+                index = cells_[index].child + quadrant(cells_[index], x[v], y[v]);
+            }
+        }
+    };
+}
+
+int GraphLayout::run(const CsrGraph& graph, const Options& options, std::vector<float>& outX, std::vector<float>& outY)
+{
+    size_t n = graph.vertexCount();
+    if (outX.size() != n || outY.size() != n) {
+        outX.assign(n, std::numeric_limits<float>::quiet_NaN());
+        outY.assign(n, std::numeric_limits<float>::quiet_NaN());
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    std::vector<double> x(n), y(n), mass(n);
+    for (size_t v = 0; v < n; ++v) {
+        x[v] = outX[v];
+        y[v] = outY[v];
+        mass[v] = graph.degree(static_cast<uint32_t>(v)) + 1.0;
+    }
+
+    // New vertices start around their placed neighbors, the rest anywhere in the spread
+    double spread = 10.0 * std::sqrt(static_cast<double>(n));
+    for (uint32_t v = 0; v < n; ++v) {
+        if (!std::isnan(x[v])) continue;
+        double sx = 0, sy = 0;
+        int placed = 0;
+        for (uint32_t u : graph.neighbors(v)) {
+            if (!std::isnan(outX[u])) {
+                sx += outX[u];
+                sy += outY[u];
+                placed++;
+            }
+        }
+        uint32_t id = graph.nodeId(v);
+        if (placed > 0) {
+            x[v] = sx / placed + hashUnit(id, 0) - 0.5;
+            y[v] = sy / placed + hashUnit(id, 1) - 0.5;
+        } else {
+            x[v] = (hashUnit(id, 0) - 0.5) * spread;
+            y[v] = (hashUnit(id, 1) - 0.5) * spread;
+        }
+    }
+
+    ThreadPool& pool = ThreadPool::current();
+    QuadTree tree;
+    std::vector<double> fx(n), fy(n), prevFx(n, 0.0), prevFy(n, 0.0);
+    std::vector<std::vector<int32_t>> stacks(pool.size());
+    std::vector<double> swingParts(pool.size()), tractionParts(pool.size());
+    double theta2 = options.theta * options.theta;
+    double speed = 1.0, speedEfficiency = 1.0;
+
+    int iteration = 0;
+    for (; iteration < options.iterations; ++iteration) {
+        tree.build(x, y, mass);
+
+        // Forces: repulsion through the tree, attraction along links, gravity to the origin
+        std::fill(swingParts.begin(), swingParts.end(), 0.0);
+        std::fill(tractionParts.begin(), tractionParts.end(), 0.0);
+        pool.parallelFor(n, LAYOUT_MORSEL, [&](size_t begin, size_t end, size_t worker) {
+            double swing = 0, traction = 0;
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t v = tree.order()[i];
+                double px = x[v], py = y[v];
+                double forceX = 0, forceY = 0;
+                tree.repulse(v, px, py, mass[v], options.repulsion, theta2,
+                             stacks[worker], forceX, forceY);
+                for (uint64_t e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e) {
+                    uint32_t u = graph.target(e);
+                    double w = graph.weight(e);
+                    forceX -= (px - x[u]) * w;
+                    forceY -= (py - y[u]) * w;
+                }
+                double distance = std::sqrt(px * px + py * py);
+                if (distance > 0) {
+                    double g = options.gravity * mass[v] / distance;
+                    forceX -= px * g;
+                    forceY -= py * g;
+                }
+                fx[v] = forceX;
+                fy[v] = forceY;
+                swing += mass[v] * std::hypot(forceX - prevFx[v], forceY - prevFy[v]);
+                traction += mass[v] * std::hypot(forceX + prevFx[v], forceY + prevFy[v]) / 2;
+            }
+            swingParts[worker] += swing;
+            tractionParts[worker] += traction;
+        });
+
+        // Global speed as in ForceAtlas2: as fast as the oscillation allows
+        double swinging = 0, traction = 0;
+        for (size_t w = 0; w < swingParts.size(); ++w) {
+            swinging += swingParts[w];
+            traction += tractionParts[w];
+        }
+        double estimated = 0.05 * std::sqrt(static_cast<double>(n));
+        double jitter = options.jitterTolerance *
+                        std::max(std::sqrt(estimated), std::min(10.0, estimated * traction / (static_cast<double>(n) * n)));
+        if (traction > 0 && swinging / traction > 2.0) {
+            if (speedEfficiency > 0.05) speedEfficiency *= 0.5;
+            jitter = std::max(jitter, options.jitterTolerance);
+        }
+        double target = swinging > 0 ? jitter * speedEfficiency * traction / swinging : speed;
+        if (swinging > jitter * traction) {
+            if (speedEfficiency > 0.05) speedEfficiency *= 0.7;
+        } else if (speed < 1000) {
+            speedEfficiency *= 1.3;
+        }
+        speed += std::min(target - speed, 0.5 * speed);
+
+        // Move: vertices whose force keeps flipping take smaller steps
+        pool.parallelFor(n, LAYOUT_MORSEL, [&](size_t begin, size_t end, size_t) {
+            for (size_t v = begin; v < end; ++v) {
+                double swing = mass[v] * std::hypot(fx[v] - prevFx[v], fy[v] - prevFy[v]);
+                double factor = speed / (1.0 + std::sqrt(speed * swing));
+                x[v] += fx[v] * factor;
+                y[v] += fy[v] * factor;
+                prevFx[v] = fx[v];
+                prevFy[v] = fy[v];
+            }
+        });
+    }
+
+    for (size_t v = 0; v < n; ++v) {
+        outX[v] = static_cast<float>(x[v]);
+        outY[v] = static_cast<float>(y[v]);
+    }
+    return iteration;
+}
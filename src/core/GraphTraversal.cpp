@@ -0,0 +1,140 @@
+#include "core/GraphTraversal.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+GraphTraversal::Neighborhood GraphTraversal::neighborhood(const CsrGraph& graph, int nodeId, int depth, size_t limit,
+                                                         const EdgeFilter& filter)
+{
+    Neighborhood result;
+    int center = nodeId >= 0 ? graph.vertexOf(static_cast<uint32_t>(nodeId)) : -1;
+    if (center < 0 || limit == 0) {
+        return result;
+    }
+
+    // Hash map rather than an n-sized array: cost follows the limit, not the graph
+    std::unordered_map<uint32_t, int> seen; // vertex -> distance
+    seen.reserve(limit * 2);
+    std::vector<uint32_t> frontier{static_cast<uint32_t>(center)};
+    std::vector<uint32_t> order{static_cast<uint32_t>(center)};
+    seen.emplace(static_cast<uint32_t>(center), 0);
+    result.levels.push_back({nodeId});
+
+    for (int d = 1; d <= depth && !frontier.empty() && !result.truncated; ++d) {
+        std::vector<uint32_t> next;
+        for (uint32_t v : frontier) {
+            for (uint64_t e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e) {
+                uint32_t u = graph.target(e);
+                if (seen.count(u) || !graph.accepts(e, filter)) continue;
+                if (order.size() >= limit) {
+                    result.truncated = true;
+                    break;
+                }
+                seen.emplace(u, d);
+                next.push_back(u);
+                order.push_back(u);
+            }
+            if (result.truncated) break;
+        }
+        if (next.empty()) break;
+
+        std::vector<int> level;
+        level.reserve(next.size());
+        for (uint32_t u : next) {
+            level.push_back(static_cast<int>(graph.nodeId(u)));
+        }
+        result.levels.push_back(std::move(level));
+        frontier = std::move(next);
+    }
+
+    // Induced edges; each one is reported from its smaller vertex
+    for (uint32_t v : order) {
+        for (uint64_t e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e) {
+            uint32_t u = graph.target(e);
+            if (u > v && seen.count(u) && graph.accepts(e, filter)) {
+                result.edges.push_back({static_cast<int>(graph.nodeId(v)), static_cast<int>(graph.nodeId(u)),
+                                        graph.weight(e), graph.edgeTypes(e)});
+            }
+        }
+    }
+    return result;
+}
+
+GraphTraversal::Path GraphTraversal::shortestPath(const CsrGraph& graph, int from, int to, size_t maxVisited,
+                                                  const EdgeFilter& filter)
+{
+    Path result;
+    int source = from >= 0 ? graph.vertexOf(static_cast<uint32_t>(from)) : -1;
+    int target = to >= 0 ? graph.vertexOf(static_cast<uint32_t>(to)) : -1;
+    if (source < 0 || target < 0) {
+        return result;
+    }
+    if (source == target) {
+        result.found = true;
+        result.nodes.push_back(from);
+        result.visited = 1;
+        return result;
+    }
+
+    // (parent, distance) per side; the start vertices point to themselves
+    std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> parent[2];
+    std::vector<uint32_t> frontier[2];
+    for (int side = 0; side < 2; ++side) {
+        uint32_t start = static_cast<uint32_t>(side == 0 ? source : target);
+        parent[side].emplace(start, std::make_pair(start, 0u));
+        frontier[side].push_back(start);
+    }
+
+    // A whole level is expanded before stopping: the first meeting vertex
+    // found is not necessarily the one closest to the other side
+    int meet = -1;
+    while (meet < 0 && !frontier[0].empty() && !frontier[1].empty()) {
+        int side = frontier[0].size() <= frontier[1].size() ? 0 : 1;
+        auto& mine = parent[side];
+        const auto& other = parent[1 - side];
+        uint32_t best = UINT32_MAX;
+
+        std::vector<uint32_t> next;
+        for (uint32_t v : frontier[side]) {
+            uint32_t dist = mine[v].second + 1;
+            for (uint64_t e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e) {
+                uint32_t u = graph.target(e);
+                if (mine.count(u) || !graph.accepts(e, filter)) continue;
+                mine.emplace(u, std::make_pair(v, dist));
+                auto it = other.find(u);
+                if (it != other.end()) {
+                    if (it->second.second < best) {
+                        best = it->second.second;
+                        meet = static_cast<int>(u);
+                    }
+                    continue;
+                }
+                next.push_back(u);
+            }
+        }
+        if (meet < 0 && parent[0].size() + parent[1].size() >= maxVisited) {
+            result.truncated = true;
+            break;
+        }
+        frontier[side] = std::move(next);
+    }
+    result.visited = parent[0].size() + parent[1].size();
+    if (meet < 0) {
+        return result;
+    }
+
+    // Walk back to the source, then forward to the target
+    std::vector<int> path;
+    for (uint32_t v = static_cast<uint32_t>(meet);; v = parent[0][v].first) {
+        path.push_back(static_cast<int>(graph.nodeId(v)));
+        if (parent[0][v].first == v) break;
+    }
+    std::reverse(path.begin(), path.end());
+    for (uint32_t v = static_cast<uint32_t>(meet); parent[1][v].first != v;) {
+        v = parent[1][v].first;
+        path.push_back(static_cast<int>(graph.nodeId(v)));
+    }
+
+    result.found = true;
+    result.nodes = std::move(path);
+    return result;
+}
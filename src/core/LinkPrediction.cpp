@@ -0,0 +1,142 @@
+#include "core/LinkPrediction.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const size_t VERTEX_MORSEL = 256;
+
+    // Reused between the vertices a worker scores
+    struct Scratch {
+        std::vector<std::pair<uint32_t, uint32_t>> via;   // (degree, neighbor)
+        std::vector<std::pair<uint32_t, double>> paths;   // (candidate, contribution) per two-hop path
+        std::vector<LinkPrediction::Suggestion> candidates;
+    };
+
+    template <typename DegreeOf>
+    LinkPrediction::Result scoreVertex(const CsrGraph& graph, uint32_t u, const LinkPrediction::Options& options,
+                                       const DegreeOf& degreeOf, Scratch& scratch) {
+        LinkPrediction::Result result;
+        const EdgeFilter& filter = options.filter;
+
+        // Neighbors through accepted links, lowest degree first
+        scratch.via.clear();
+        for (uint64_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+            if (graph.accepts(e, filter)) {
+                uint32_t w = graph.target(e);
+                scratch.via.emplace_back(degreeOf(w), w);
+            }
+        }
+        std::sort(scratch.via.begin(), scratch.via.end());
+
+        scratch.paths.clear();
+        for (const auto& [degree, w] : scratch.via) {
+            if (degree <= 1) {
+                continue; // Only links back to u
+            }
+            if (result.paths + degree > options.maxPaths) {
+                result.truncated = true;
+                break;
+            }
+            result.paths += degree;
+            double contribution = 1.0;
+            if (options.score == LinkPrediction::Score::ADAMIC_ADAR) {
+                contribution = 1.0 / std::log(static_cast<double>(degree));
+            } else if (options.score == LinkPrediction::Score::RESOURCE_ALLOCATION) {
+                contribution = 1.0 / degree;
+            }
+            for (uint64_t e = graph.edgeBegin(w); e < graph.edgeEnd(w); ++e) {
+                uint32_t x = graph.target(e);
+                if (x != u && graph.accepts(e, filter)) {
+                    scratch.paths.emplace_back(x, contribution);
+                }
+            }
+        }
+        std::sort(scratch.paths.begin(), scratch.paths.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        // Linked under any type already: nothing to suggest
+        CsrGraph::Neighbors linked = graph.neighbors(u);
+        auto& candidates = scratch.candidates;
+        candidates.clear();
+        uint32_t sourceDegree = static_cast<uint32_t>(scratch.via.size());
+        for (size_t i = 0; i < scratch.paths.size();) {
+            uint32_t x = scratch.paths[i].first;
+            double score = 0.0;
+            uint32_t common = 0;
+            for (; i < scratch.paths.size() && scratch.paths[i].first == x; ++i) {
+                score += scratch.paths[i].second;
+                common++;
+            }
+            if (std::binary_search(linked.begin(), linked.end(), x)) {
+                continue;
+            }
+            if (options.score == LinkPrediction::Score::JACCARD) {
+                score = static_cast<double>(common) / (sourceDegree + degreeOf(x) - common);
+            }
+            candidates.push_back({x, score, common});
+        }
+
+        auto better = [](const LinkPrediction::Suggestion& a, const LinkPrediction::Suggestion& b) {
+            return a.score != b.score ? a.score > b.score : a.vertex < b.vertex;
+        };
+        // Only the top is copied out: scratch capacity stays with the worker
+        size_t keep = std::min(options.limit, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(), better);
+        result.suggestions.assign(candidates.begin(), candidates.begin() + keep);
+        return result;
+    }
+}
+
+LinkPrediction::Result LinkPrediction::suggest(const CsrGraph& graph, uint32_t vertex, const Options& options)
+{
+    if (vertex >= graph.vertexCount()) {
+        return {};
+    }
+    Scratch scratch;
+    auto degreeOf = [&](uint32_t v) { return graph.degree(v, options.filter); };
+    return scoreVertex(graph, vertex, options, degreeOf, scratch);
+}
+
+std::vector<std::vector<LinkPrediction::Suggestion>> LinkPrediction::suggestAll(const CsrGraph& graph, const Options& options)
+{
+    size_t n = graph.vertexCount();
+    ThreadPool& pool = ThreadPool::current();
+
+    // Filtered degrees are read once per two-hop path: count them up front
+    std::vector<uint32_t> degrees(n);
+    pool.parallelFor(n, VERTEX_MORSEL * 16, [&](size_t begin, size_t end, size_t) {
+        for (size_t v = begin; v < end; ++v) {
+            degrees[v] = graph.degree(static_cast<uint32_t>(v), options.filter);
+        }
+    });
+    auto degreeOf = [&degrees](uint32_t v) { return degrees[v]; };
+
+    std::vector<std::vector<Suggestion>> result(n);
+    std::vector<Scratch> scratch(pool.size());
+    pool.parallelFor(n, VERTEX_MORSEL, [&](size_t begin, size_t end, size_t worker) {
+        for (size_t v = begin; v < end; ++v) {
+            result[v] = scoreVertex(graph, static_cast<uint32_t>(v), options, degreeOf, scratch[worker]).suggestions;
+        }
+    });
+    return result;
+}
+
+bool LinkPrediction::parseScore(const std::string& name, Score& score)
+{
+    if (name == "adamic_adar") score = Score::ADAMIC_ADAR;
+    else if (name == "jaccard") score = Score::JACCARD;
+    else if (name == "resource_allocation") score = Score::RESOURCE_ALLOCATION;
+    else return false;
+    return true;
+}
+
+const char* LinkPrediction::scoreName(Score score)
+{
+    switch (score) {
+        case Score::ADAMIC_ADAR: return "adamic_adar";
+        case Score::JACCARD: return "jaccard";
+        case Score::RESOURCE_ALLOCATION: return "resource_allocation";
+    }
+    return "adamic_adar";
+}
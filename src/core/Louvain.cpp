@@ -0,0 +1,278 @@
+#include "core/Louvain.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <numeric>
+
+namespace {
+    const size_t VERTEX_MORSEL = 1024;
+
+    // Symmetric weighted adjacency; folded edges become self-loop weight
+    struct WeightedGraph {
+        std::vector<uint64_t> offsets{0};
+        std::vector<uint32_t> targets;
+        std::vector<double> weights;
+        std::vector<double> selfLoops; // Both directions of every folded edge
+        size_t size() const { return offsets.size() - 1; }
+    };
+
+    void atomicAdd(std::atomic<double>& target, double delta) {
+        double current = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {}
+    }
+
+    // Neighbor communities of one vertex with summed edge weight, sorted by community
+    void gatherCommunities(const WeightedGraph& g, uint32_t v, const std::atomic<uint32_t>* community,
+                           std::vector<std::pair<uint32_t, double>>& out) {
+        out.clear();
+        for (uint64_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+            out.emplace_back(community[g.targets[e]].load(std::memory_order_relaxed), g.weights[e]);
+        }
+        std::sort(out.begin(), out.end());
+        size_t w = 0;
+        for (size_t r = 0; r < out.size(); ++r) {
+            if (w > 0 && out[w - 1].first == out[r].first) {
+                out[w - 1].second += out[r].second;
+            } else {
+                out[w++] = out[r];
+            }
+        }
+        out.resize(w);
+    }
+
+    WeightedGraph fromCsr(const CsrGraph& graph, const EdgeFilter& filter) {
+        WeightedGraph g;
+        size_t n = graph.vertexCount();
+        g.offsets.assign(n + 1, 0);
+        g.selfLoops.assign(n, 0.0);
+        for (uint32_t v = 0; v < n; ++v) {
+            g.offsets[v + 1] = g.offsets[v] + graph.degree(v, filter);
+        }
+        g.targets.resize(g.offsets[n]);
+        g.weights.resize(g.offsets[n]);
+        ThreadPool::current().parallelFor(n, VERTEX_MORSEL, [&](size_t begin, size_t end, size_t) {
+            for (size_t v = begin; v < end; ++v) {
+                uint64_t out = g.offsets[v];
+                for (uint64_t e = graph.edgeBegin(static_cast<uint32_t>(v)); e < graph.edgeEnd(static_cast<uint32_t>(v)); ++e) {
+                    if (!graph.accepts(e, filter)) continue;
+                    g.targets[out] = graph.target(e);
+                    g.weights[out] = graph.weight(e);
+                    out++;
+                }
+            }
+        });
+        return g;
+    }
+
+    double modularity(const WeightedGraph& g, const std::atomic<uint32_t>* community,
+                      const std::vector<double>& degree, double totalWeight, double resolution) {
+        ThreadPool& pool = ThreadPool::current();
+        size_t n = g.size();
+        std::vector<double> inside(pool.size(), 0.0);
+        std::vector<double> totals(n, 0.0);
+        for (size_t v = 0; v < n; ++v) {
+            totals[community[v].load(std::memory_order_relaxed)] += degree[v];
+        }
+        pool.parallelFor(n, VERTEX_MORSEL, [&](size_t begin, size_t end, size_t worker) {
+            double sum = 0.0;
+            for (size_t v = begin; v < end; ++v) {
+                uint32_t c = community[v].load(std::memory_order_relaxed);
+                sum += g.selfLoops[v];
+                for (uint64_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+                    if (community[g.targets[e]].load(std::memory_order_relaxed) == c) sum += g.weights[e];
+                }
+            }
+            inside[worker] += sum;
+        });
+
+        double q = std::accumulate(inside.begin(), inside.end(), 0.0) / totalWeight;
+        for (double tot : totals) {
+            q -= resolution * (tot / totalWeight) * (tot / totalWeight);
+        }
+        return q;
+    }
+
+    // One level of local moving; fills `community` and returns the sweeps run
+    int moveVertices(const WeightedGraph& g, const Louvain::Options& options, std::atomic<uint32_t>* community,
+                     double& quality, bool& moved) {
+        ThreadPool& pool = ThreadPool::current();
+        size_t n = g.size();
+
+        std::vector<double> degree(n);
+        for (size_t v = 0; v < n; ++v) {
+            degree[v] = g.selfLoops[v];
+            for (uint64_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) degree[v] += g.weights[e];
+        }
+        double totalWeight = std::accumulate(degree.begin(), degree.end(), 0.0);
+
+        std::unique_ptr<std::atomic<double>[]> totals(new std::atomic<double>[n]);
+        for (size_t v = 0; v < n; ++v) {
+            community[v].store(static_cast<uint32_t>(v), std::memory_order_relaxed);
+            totals[v].store(degree[v], std::memory_order_relaxed);
+        }
+        moved = false;
+        if (totalWeight <= 0.0) {
+            quality = 0.0;
+            return 0;
+        }
+
+        double scale = options.resolution / totalWeight;
+        quality = modularity(g, community, degree, totalWeight, options.resolution);
+        std::vector<std::vector<std::pair<uint32_t, double>>> scratch(pool.size());
+
+        int sweep = 0;
+        std::vector<uint32_t> before(n);
+        while (sweep < options.maxSweeps) {
+            for (size_t v = 0; v < n; ++v) before[v] = community[v].load(std::memory_order_relaxed);
+            std::atomic<size_t> moves{0};
+            pool.parallelFor(n, VERTEX_MORSEL, [&](size_t begin, size_t end, size_t worker) {
+                auto& neighbors = scratch[worker];
+                size_t local = 0;
+                for (size_t v = begin; v < end; ++v) {
+                    if (g.offsets[v] == g.offsets[v + 1]) continue;
+                    uint32_t current = community[v].load(std::memory_order_relaxed);
+                    gatherCommunities(g, static_cast<uint32_t>(v), community, neighbors);
+
+                    // Gain of joining c: w(v, c) - resolution * k_v * tot(c) / 2m, with v taken out of its own
+                    double k = degree[v];
+                    double stay = -scale * k * (totals[current].load(std::memory_order_relaxed) - k);
+                    for (const auto& [c, w] : neighbors) {
+                        if (c == current) stay += w;
+                    }
+                    uint32_t best = current;
+                    double bestGain = stay;
+                    for (const auto& [c, w] : neighbors) {
+                        if (c == current) continue;
+                        double gain = w - scale * k * totals[c].load(std::memory_order_relaxed);
+                        if (gain > bestGain + 1e-12 || (gain == bestGain && c < best && best != current)) {
+                            best = c;
+                            bestGain = gain;
+                        }
+                    }
+                    if (best != current) {
+                        atomicAdd(totals[current], -k);
+                        atomicAdd(totals[best], k);
+                        community[v].store(best, std::memory_order_relaxed);
+                        local++;
+                    }
+                }
+                moves.fetch_add(local, std::memory_order_relaxed);
+            });
+            sweep++;
+            if (moves.load() == 0) break;
+
+            // Concurrent moves read slightly stale totals, so check the real gain
+            double next = modularity(g, community, degree, totalWeight, options.resolution);
+            double gain = next - quality;
+            if (gain < 0) {
+                // The sweep made things worse: keep the assignment it started from
+                for (size_t v = 0; v < n; ++v) community[v].store(before[v], std::memory_order_relaxed);
+                break;
+            }
+            moved = true;
+            quality = next;
+            if (gain < options.minGain) break;
+        }
+        return sweep;
+    }
+
+    // Communities become vertices; returns the dense id of every old vertex
+    WeightedGraph aggregate(const WeightedGraph& g, const std::atomic<uint32_t>* community,
+                            std::vector<uint32_t>& dense, size_t& count) {
+        size_t n = g.size();
+        dense.assign(n, UINT32_MAX);
+        std::vector<uint32_t> ids(n, UINT32_MAX);
+        count = 0;
+        for (size_t v = 0; v < n; ++v) {
+            uint32_t c = community[v].load(std::memory_order_relaxed);
+            if (ids[c] == UINT32_MAX) ids[c] = static_cast<uint32_t>(count++);
+            dense[v] = ids[c];
+        }
+
+        // Members grouped by new vertex (counting sort)
+        std::vector<uint64_t> start(count + 1, 0);
+        for (size_t v = 0; v < n; ++v) start[dense[v] + 1]++;
+        for (size_t c = 0; c < count; ++c) start[c + 1] += start[c];
+        std::vector<uint32_t> members(n);
+        std::vector<uint64_t> cursor(start.begin(), start.end() - 1);
+        for (size_t v = 0; v < n; ++v) members[cursor[dense[v]]++] = static_cast<uint32_t>(v);
+
+        WeightedGraph out;
+        out.selfLoops.assign(count, 0.0);
+        std::vector<std::vector<std::pair<uint32_t, double>>> rows(count);
+        ThreadPool::current().parallelFor(count, VERTEX_MORSEL / 4, [&](size_t begin, size_t end, size_t) {
+            std::vector<std::pair<uint32_t, double>> edges;
+            for (size_t c = begin; c < end; ++c) {
+                edges.clear();
+                double self = 0.0;
+                for (uint64_t i = start[c]; i < start[c + 1]; ++i) {
+                    uint32_t v = members[i];
+                    self += g.selfLoops[v];
+                    for (uint64_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+                        uint32_t u = dense[g.targets[e]];
+                        if (u == c) self += g.weights[e];
+                        else edges.emplace_back(u, g.weights[e]);
+                    }
+                }
+                std::sort(edges.begin(), edges.end());
+                auto& row = rows[c];
+                for (const auto& [u, w] : edges) {
+                    if (!row.empty() && row.back().first == u) row.back().second += w;
+                    else row.emplace_back(u, w);
+                }
+                out.selfLoops[c] = self;
+            }
+        });
+
+        out.offsets.assign(count + 1, 0);
+        for (size_t c = 0; c < count; ++c) out.offsets[c + 1] = out.offsets[c] + rows[c].size();
+        out.targets.resize(out.offsets[count]);
+        out.weights.resize(out.offsets[count]);
+        for (size_t c = 0; c < count; ++c) {
+            uint64_t e = out.offsets[c];
+            for (const auto& [u, w] : rows[c]) {
+                out.targets[e] = u;
+                out.weights[e] = w;
+                e++;
+            }
+        }
+        return out;
+    }
+}
+
+Louvain::Result Louvain::run(const CsrGraph& graph, const Options& options)
+{
+    Result result;
+    size_t n = graph.vertexCount();
+    result.community.resize(n);
+    std::iota(result.community.begin(), result.community.end(), 0u);
+    result.communities = n;
+    if (n == 0) {
+        return result;
+    }
+
+    WeightedGraph g = fromCsr(graph, options.filter);
+    while (result.levels < options.maxLevels) {
+        size_t size = g.size();
+        std::unique_ptr<std::atomic<uint32_t>[]> community(new std::atomic<uint32_t>[size]);
+        bool moved = false;
+        result.sweeps += moveVertices(g, options, community.get(), result.modularity, moved);
+        result.levels++;
+        if (!moved) {
+            break;
+        }
+
+        std::vector<uint32_t> dense;
+        size_t count = 0;
+        g = aggregate(g, community.get(), dense, count);
+        for (auto& c : result.community) {
+            c = dense[c];
+        }
+        result.communities = count;
+        if (count == size) {
+            break;
+        }
+    }
+    return result;
+}
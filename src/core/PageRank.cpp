@@ -0,0 +1,81 @@
+#include "core/PageRank.hpp"
+#include "core/ThreadPool.hpp"
+#include <cmath>
+#include <numeric>
+
+namespace {
+    const size_t RANK_MORSEL = 4096;
+}
+
+PageRank::Result PageRank::compute(const CsrGraph& graph, const Options& options, const std::vector<double>& warmStart)
+{
+    Result result;
+    size_t n = graph.vertexCount();
+    if (n == 0) {
+        return result;
+    }
+
+    bool filtered = !options.filter.all();
+    bool personalized = options.source >= 0 && static_cast<size_t>(options.source) < n;
+    auto teleport = [&](size_t v) {
+        if (personalized) return v == static_cast<size_t>(options.source) ? 1.0 : 0.0;
+        return 1.0 / static_cast<double>(n);
+    };
+
+    std::vector<double> rank(n);
+    double warmSum = warmStart.size() == n ? std::accumulate(warmStart.begin(), warmStart.end(), 0.0) : 0.0;
+    for (size_t v = 0; v < n; ++v) {
+        rank[v] = warmSum > 0 ? warmStart[v] / warmSum : teleport(v);
+    }
+
+    ThreadPool& pool = ThreadPool::current();
+    std::vector<double> contribution(n);
+    std::vector<double> next(n);
+    std::vector<double> partial(pool.size());
+
+    for (result.iterations = 0; result.iterations < options.maxIterations;) {
+        // Per-vertex outflow, plus the mass sitting on vertices without links
+        std::fill(partial.begin(), partial.end(), 0.0);
+        pool.parallelFor(n, RANK_MORSEL, [&](size_t begin, size_t end, size_t worker) {
+            double dangling = 0.0;
+            for (size_t v = begin; v < end; ++v) {
+                uint32_t degree = graph.degree(static_cast<uint32_t>(v), options.filter);
+                contribution[v] = degree ? rank[v] / degree : 0.0;
+                if (!degree) dangling += rank[v];
+            }
+            partial[worker] += dangling;
+        });
+        double dangling = std::accumulate(partial.begin(), partial.end(), 0.0);
+
+        std::fill(partial.begin(), partial.end(), 0.0);
+        pool.parallelFor(n, RANK_MORSEL, [&](size_t begin, size_t end, size_t worker) {
+            double change = 0.0;
+            for (size_t v = begin; v < end; ++v) {
+                double sum = 0.0;
+                if (filtered) {
+                    for (uint64_t e = graph.edgeBegin(static_cast<uint32_t>(v)); e < graph.edgeEnd(static_cast<uint32_t>(v)); ++e) {
+                        if (graph.accepts(e, options.filter)) sum += contribution[graph.target(e)];
+                    }
+                } else {
+                    for (uint32_t u : graph.neighbors(static_cast<uint32_t>(v))) {
+                        sum += contribution[u];
+                    }
+                }
+                double t = teleport(v);
+                next[v] = (1.0 - options.damping) * t + options.damping * (sum + dangling * t);
+                change += std::fabs(next[v] - rank[v]);
+            }
+            partial[worker] += change;
+        });
+
+        rank.swap(next);
+        result.iterations++;
+        result.residual = std::accumulate(partial.begin(), partial.end(), 0.0);
+        if (result.residual < options.tolerance) {
+            break;
+        }
+    }
+
+    result.scores = std::move(rank);
+    return result;
+}
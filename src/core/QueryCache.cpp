@@ -0,0 +1,103 @@
+#include "core/QueryCache.hpp"
+
+namespace {
+    // Rough heap footprint of a json value: good enough to budget the cache
+    size_t approxBytes(const nlohmann::json& j)
+    {
+        size_t bytes = sizeof(nlohmann::json);
+        if (j.is_string()) {
+            bytes += j.get_ref<const std::string&>().size();
+        } else if (j.is_array()) {
+            for (const auto& item : j) bytes += approxBytes(item);
+        } else if (j.is_object()) {
+            for (const auto& item : j.items()) bytes += 32 + item.key().size() + approxBytes(item.value());
+        }
+        return bytes;
+    }
+}
+
+QueryCache::QueryCache(size_t capacity, size_t maxBytes) : capacity_(capacity), maxBytes_(maxBytes) {}
+
+bool QueryCache::get(const std::string& key, uint64_t generation, nlohmann::json& out)
+{
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        misses_++;
+        return false;
+    }
+
+    // Entry was computed before the last mutation - drop it
+    if (it->second->generation != generation) {
+        erase(it->second);
+        misses_++;
+        return false;
+    }
+
+    // Move to front (most recently used)
+    lru_.splice(lru_.begin(), lru_, it->second);
+    out = it->second->value;
+    hits_++;
+    return true;
+}
+
+void QueryCache::put(const std::string& key, uint64_t generation, nlohmann::json value)
+{
+    if (capacity_ == 0) {
+        return;
+    }
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        erase(it->second);
+    }
+
+    // One oversized result would push out everything else
+    size_t bytes = key.size() + approxBytes(value);
+    if (bytes > maxBytes_ / 4) {
+        return;
+    }
+
+    lru_.push_front({key, generation, std::move(value), bytes});
+    index_[key] = lru_.begin();
+    bytes_ += bytes;
+    evict();
+}
+
+void QueryCache::clear()
+{
+    lru_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+void QueryCache::setCapacity(size_t capacity)
+{
+    capacity_ = capacity;
+    evict();
+}
+
+nlohmann::json QueryCache::stats() const
+{
+    return {
+        {"size", lru_.size()},
+        {"capacity", capacity_},
+        {"bytes", bytes_},
+        {"maxBytes", maxBytes_},
+        {"hits", hits_},
+        {"misses", misses_}
+    };
+}
+
+void QueryCache::evict()
+{
+    while (lru_.size() > capacity_ || bytes_ > maxBytes_) {
+        erase(std::prev(lru_.end()));
+    }
+}
+
+void QueryCache::erase(std::list<Entry>::iterator it)
+{
+    bytes_ -= it->bytes;
+    index_.erase(it->key);
+    lru_.erase(it);
+}
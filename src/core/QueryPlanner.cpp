@@ -0,0 +1,178 @@
+#include "core/QueryPlanner.hpp"
+#include <algorithm>
+#include <cmath>
+
+std::string QueryPredicate::describe() const
+{
+    if (field == "course_range" || field == "date_range") {
+        return field + "[" + std::to_string(lo) + ".." + std::to_string(hi) + "]";
+    }
+    if (field == "title") {
+        return "title contains \"" + value + "\"";
+    }
+    return field + "=" + value;
+}
+
+const char* to_string(AccessPath path)
+{
+    switch (path) {
+        case AccessPath::FULL_SCAN: return "full_scan";
+        case AccessPath::INDEX_PROBE: return "index_probe";
+        case AccessPath::BITMAP_INTERSECTION: return "bitmap_intersection";
+        case AccessPath::ORDERED_INDEX_WALK: return "ordered_index_walk";
+        default: return "unknown";
+    }
+}
+
+double QueryPlanner::sortCost(double rows, int limit, int offset)
+{
+    if (rows <= 1.0) {
+        return 0.0;
+    }
+    // Top-k sort when a limit is given
+    double k = rows;
+    if (limit > 0) {
+        k = std::min(rows, static_cast<double>(std::max(offset, 0)) + limit);
+    }
+    return rows * std::log2(std::max(k, 2.0)) * COMPARE_COST;
+}
+
+double QueryPlanner::buildCost(const QueryPredicate& p)
+{
+    if (p.field == "date_range") {
+        return static_cast<double>(p.estimate) * RANGE_BUILD_COST;
+    }
+    if (p.field == "course_range") {
+        return static_cast<double>(p.estimate) * BITMAP_ELEMENT_COST;
+    }
+    return 0.0;
+}
+
+QueryPlan QueryPlanner::plan(const Input& input)
+{
+    const auto& predicates = *input.predicates;
+    double total = static_cast<double>(std::max<uint64_t>(input.totalRows, 1));
+
+    QueryPlan plan;
+    plan.sortBy = input.sortBy;
+    plan.ascending = input.ascending;
+
+    // Split predicates and estimate output size assuming independence
+    std::vector<size_t> indexed, residual;
+    double selectivity = 1.0;
+    double indexSelectivity = 1.0;
+    for (size_t i = 0; i < predicates.size(); ++i) {
+        if (predicates[i].indexed) {
+            indexed.push_back(i);
+            indexSelectivity *= std::min(1.0, predicates[i].estimate / total);
+        } else {
+            residual.push_back(i);
+            selectivity *= SUBSTRING_SELECTIVITY;
+        }
+    }
+    selectivity *= indexSelectivity;
+    std::sort(indexed.begin(), indexed.end(), [&predicates](size_t a, size_t b) {
+        return predicates[a].estimate < predicates[b].estimate;
+    });
+
+    double outRows = total * selectivity;
+    double sorting = sortCost(outRows, input.limit, input.offset);
+    std::vector<size_t> all(predicates.size());
+    for (size_t i = 0; i < all.size(); ++i) all[i] = i;
+
+    auto consider = [&plan](AccessPath path, double cost,
+                            std::vector<size_t> idx, std::vector<size_t> res, bool sorted) {
+        plan.alternatives.emplace_back(path, cost);
+        if (plan.alternatives.size() == 1 || cost < plan.estimatedCost) {
+            plan.access = path;
+            plan.estimatedCost = cost;
+            plan.indexed = std::move(idx);
+            plan.residual = std::move(res);
+            plan.sortedByIndex = sorted;
+        }
+    };
+
+    // Full scan: every row fetched and checked
+    consider(AccessPath::FULL_SCAN, total * ROW_COST + sorting, {}, all, false);
+
+    // Probe the most selective index, check everything else per row
+    if (!indexed.empty()) {
+        const QueryPredicate& driver = predicates[indexed[0]];
+        std::vector<size_t> rest;
+        for (size_t i : all) {
+            if (i != indexed[0]) rest.push_back(i);
+        }
+        double cost = buildCost(driver) + driver.estimate * ROW_COST + sorting;
+        consider(AccessPath::INDEX_PROBE, cost, {indexed[0]}, rest, false);
+    }
+
+    // Intersect all indexed postings, fetch only the survivors
+    if (indexed.size() >= 2) {
+        double cost = 0.0;
+        for (size_t i : indexed) {
+            cost += buildCost(predicates[i]) + predicates[i].estimate * BITMAP_ELEMENT_COST;
+        }
+        cost += total * indexSelectivity * ROW_COST + sorting;
+        consider(AccessPath::BITMAP_INTERSECTION, cost, indexed, residual, false);
+    }
+
+    // Walk the sort order and stop once offset+limit rows matched
+    if (input.orderedIndex) {
+        double examined = total;
+        if (input.limit > 0) {
+            double needed = static_cast<double>(std::max(input.offset, 0)) + input.limit;
+            examined = std::min(total, needed / std::max(selectivity, 1.0 / total));
+        }
+        consider(AccessPath::ORDERED_INDEX_WALK, examined * ROW_COST, {}, all, true);
+    }
+
+    plan.estimatedRows = outRows;
+    return plan;
+}
+
+nlohmann::json QueryPlan::to_json(const std::vector<QueryPredicate>& predicates) const
+{
+    nlohmann::json j;
+    j["access"] = to_string(access);
+
+    j["indexes"] = nlohmann::json::array();
+    for (size_t i : indexed) {
+        j["indexes"].push_back({
+            {"predicate", predicates[i].describe()},
+            {"estimatedRows", predicates[i].estimate}
+        });
+    }
+
+    j["residual"] = nlohmann::json::array();
+    for (size_t i : residual) {
+        j["residual"].push_back(predicates[i].describe());
+    }
+
+    j["sort"] = {
+        {"field", sortBy},
+        {"order", ascending ? "asc" : "desc"},
+        {"fromIndex", sortedByIndex},
+        {"fromScan", sortedByScan}
+    };
+    j["estimatedRows"] = estimatedRows;
+    j["estimatedCost"] = estimatedCost;
+
+    j["alternatives"] = nlohmann::json::array();
+    for (const auto& [path, cost] : alternatives) {
+        j["alternatives"].push_back({{"access", to_string(path)}, {"cost", cost}});
+    }
+
+    j["cacheHit"] = cacheHit;
+    j["rowsExamined"] = rowsExamined;
+    j["rowsMatched"] = rowsMatched;
+    j["rowsReturned"] = rowsReturned;
+    j["workers"] = workers;
+    j["timings"] = {
+        {"planUs", planUs},
+        {"executeUs", executeUs},
+        {"sortUs", sortUs},
+        {"serializeUs", serializeUs},
+        {"totalUs", planUs + executeUs + sortUs + serializeUs}
+    };
+    return j;
+}
@@ -0,0 +1,91 @@
+#include "core/TagCompleter.hpp"
+#include <algorithm>
+#include <queue>
+#include <tuple>
+
+void TagCompleter::build(std::vector<Entry> entries)
+{
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.name < b.name;
+    });
+    entries_ = std::move(entries);
+
+    size_t n = entries_.size();
+    maxIndex_.clear();
+    if (n == 0) {
+        return;
+    }
+
+    maxIndex_.emplace_back(n);
+    for (size_t i = 0; i < n; ++i) {
+        maxIndex_[0][i] = static_cast<uint32_t>(i);
+    }
+    for (size_t len = 2; len <= n; len *= 2) {
+        const auto& prev = maxIndex_.back();
+        std::vector<uint32_t> level(n - len + 1);
+        for (size_t i = 0; i + len <= n; ++i) {
+            level[i] = better(prev[i], prev[i + len / 2]);
+        }
+        maxIndex_.push_back(std::move(level));
+    }
+}
+
+void TagCompleter::clear()
+{
+    entries_.clear();
+    maxIndex_.clear();
+}
+
+uint32_t TagCompleter::better(uint32_t a, uint32_t b) const
+{
+    // Names are sorted, so the lower index wins ties
+    if (entries_[a].weight != entries_[b].weight) {
+        return entries_[a].weight > entries_[b].weight ? a : b;
+    }
+    return std::min(a, b);
+}
+
+uint32_t TagCompleter::best(size_t begin, size_t end) const
+{
+    size_t level = 0;
+    while ((size_t{2} << level) <= end - begin) ++level;
+    return better(maxIndex_[level][begin], maxIndex_[level][end - (size_t{1} << level)]);
+}
+
+std::pair<size_t, size_t> TagCompleter::range(std::string_view prefix) const
+{
+    auto first = std::lower_bound(entries_.begin(), entries_.end(), prefix, [](const Entry& e, std::string_view p) {
+        return std::string_view(e.name) < p;
+    });
+    auto last = std::partition_point(first, entries_.end(), [prefix](const Entry& e) {
+        return std::string_view(e.name).substr(0, prefix.size()) == prefix;
+    });
+    return {static_cast<size_t>(first - entries_.begin()), static_cast<size_t>(last - entries_.begin())};
+}
+
+std::vector<const TagCompleter::Entry*> TagCompleter::complete(std::string_view prefix, size_t k) const
+{
+    std::vector<const Entry*> result;
+    auto [begin, end] = range(prefix);
+    if (begin == end || k == 0) {
+        return result;
+    }
+
+    // Each heap item is a sub-range with its best entry; taking that entry
+    // splits the range in two around it
+    using Item = std::tuple<uint32_t, size_t, size_t>; // (best index, begin, end)
+    auto worse = [this](const Item& a, const Item& b) {
+        return better(std::get<0>(a), std::get<0>(b)) != std::get<0>(a);
+    };
+    std::priority_queue<Item, std::vector<Item>, decltype(worse)> heap(worse);
+    heap.emplace(best(begin, end), begin, end);
+
+    while (!heap.empty() && result.size() < k) {
+        auto [top, lo, hi] = heap.top();
+        heap.pop();
+        result.push_back(&entries_[top]);
+        if (lo < top) heap.emplace(best(lo, top), lo, top);
+        if (top + 1 < hi) heap.emplace(best(top + 1, hi), top + 1, hi);
+    }
+    return result;
+}
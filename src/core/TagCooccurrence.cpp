@@ -0,0 +1,124 @@
+#include "core/TagCooccurrence.hpp"
+#include <algorithm>
+#include <cmath>
+
+void TagCooccurrence::addSet(const std::vector<TagId>& tags)
+{
+    if (tags.size() < 2) {
+        return;
+    }
+    if (rows_.size() <= tags.back()) {
+        rows_.resize(tags.back() + 1);
+    }
+    for (size_t i = 0; i < tags.size(); ++i) {
+        for (size_t j = i + 1; j < tags.size(); ++j) {
+            rows_[tags[i]][tags[j]]++;
+            rows_[tags[j]][tags[i]]++;
+        }
+    }
+}
+
+void TagCooccurrence::removeSet(const std::vector<TagId>& tags)
+{
+    auto drop = [this](TagId a, TagId b) {
+        if (a >= rows_.size()) return;
+        auto it = rows_[a].find(b);
+        if (it != rows_[a].end() && --it->second == 0) {
+            rows_[a].erase(it);
+        }
+    };
+
+    for (size_t i = 0; i < tags.size(); ++i) {
+        for (size_t j = i + 1; j < tags.size(); ++j) {
+            drop(tags[i], tags[j]);
+            drop(tags[j], tags[i]);
+        }
+    }
+}
+
+uint32_t TagCooccurrence::count(TagId a, TagId b) const
+{
+    if (a >= rows_.size()) {
+        return 0;
+    }
+    auto it = rows_[a].find(b);
+    return it != rows_[a].end() ? it->second : 0;
+}
+
+double TagCooccurrence::lift(uint32_t both, uint32_t a, uint32_t b, uint64_t total)
+{
+    if (both == 0 || a == 0 || b == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(both) * static_cast<double>(total) /
+           (static_cast<double>(a) * static_cast<double>(b));
+}
+
+void TagCooccurrence::topK(std::vector<TagScore>& scores, size_t k)
+{
+    auto better = [](const TagScore& x, const TagScore& y) {
+        if (x.pmi != y.pmi) return x.pmi > y.pmi;
+        if (x.count != y.count) return x.count > y.count;
+        return x.tag < y.tag;
+    };
+    if (k > 0 && k < scores.size()) {
+        std::partial_sort(scores.begin(), scores.begin() + k, scores.end(), better);
+        scores.resize(k);
+    } else {
+        std::sort(scores.begin(), scores.end(), better);
+    }
+}
+
+std::vector<TagScore> TagCooccurrence::related(TagId tag, const TagDictionary& dict, uint64_t total,
+                                               size_t k, uint32_t minCount) const
+{
+    std::vector<TagScore> scores;
+    if (tag >= rows_.size()) {
+        return scores;
+    }
+
+    uint32_t usage = dict.usage(tag);
+    scores.reserve(rows_[tag].size());
+    for (const auto& [other, both] : rows_[tag]) {
+        if (both < minCount) continue;
+        TagScore s;
+        s.tag = other;
+        s.count = both;
+        s.lift = lift(both, usage, dict.usage(other), total);
+        s.pmi = s.lift > 0 ? std::log2(s.lift) : 0.0;
+        scores.push_back(s);
+    }
+
+    topK(scores, k);
+    return scores;
+}
+
+std::vector<TagScore> TagCooccurrence::suggest(const std::vector<TagId>& context, const TagDictionary& dict,
+                                               uint64_t total, size_t k, uint32_t minCount) const
+{
+    std::unordered_map<TagId, TagScore> merged;
+    for (TagId tag : context) {
+        if (tag >= rows_.size()) continue;
+        uint32_t usage = dict.usage(tag);
+        for (const auto& [other, both] : rows_[tag]) {
+            if (both < minCount) continue;
+            double l = lift(both, usage, dict.usage(other), total);
+            TagScore& s = merged[other];
+            s.tag = other;
+            s.count += both;
+            s.lift += l;
+            s.pmi += l > 1.0 ? std::log2(l) : 0.0; // Only positive association counts
+        }
+    }
+
+    std::vector<TagScore> scores;
+    scores.reserve(merged.size());
+    for (const auto& [tag, score] : merged) {
+        if (std::find(context.begin(), context.end(), tag) == context.end()) {
+            scores.push_back(score);
+        }
+    }
+
+    topK(scores, k);
+    return scores;
+}
@@ -0,0 +1,60 @@
+#include "core/TagDictionary.hpp"
+#include <algorithm>
+
+TagId TagDictionary::intern(const std::string& name)
+{
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    TagId id = static_cast<TagId>(names_.size());
+    names_.push_back(name);
+    usage_.push_back(0);
+    inBank_.push_back(false);
+    ids_.emplace(name, id);
+    return id;
+}
+
+TagId TagDictionary::find(const std::string& name) const
+{
+    auto it = ids_.find(name);
+    return it != ids_.end() ? it->second : NO_TAG;
+}
+
+void TagDictionary::resetUsage()
+{
+    std::fill(usage_.begin(), usage_.end(), 0);
+}
+
+bool TagDictionary::addToBank(const std::string& name)
+{
+    TagId id = intern(name);
+    if (inBank_[id]) {
+        return false;
+    }
+    inBank_[id] = true;
+    bank_.push_back(name);
+    return true;
+}
+
+bool TagDictionary::inBank(const std::string& name) const
+{
+    TagId id = find(name);
+    return id != NO_TAG && inBank_[id];
+}
+
+void TagDictionary::clearBank()
+{
+    std::fill(inBank_.begin(), inBank_.end(), false);
+    bank_.clear();
+}
+
+void TagDictionary::clear()
+{
+    names_.clear();
+    usage_.clear();
+    inBank_.clear();
+    ids_.clear();
+    bank_.clear();
+}
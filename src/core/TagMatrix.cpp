@@ -0,0 +1,258 @@
+#include "core/TagMatrix.hpp"
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace {
+    // A bit column costs rows / 8 bytes, a row list 4 bytes per row that has
+    // the tag: columns pay off for tags on more than 1/32 of the rows
+    const size_t DENSE_SHARE = 32;
+
+    bool isDense(size_t frequency, size_t rows) {
+        return frequency > 0 && frequency * DENSE_SHARE >= rows;
+    }
+
+    // counts[r] += popcount(plane[r] & mask) for r in [0, n)
+    void andPopcountAccumulate(const uint64_t* plane, uint64_t mask, uint32_t* counts, size_t n) {
+        size_t r = 0;
+#ifdef __AVX2__
+        // Nibble lookup popcount; SAD folds the byte counts into one sum per 64-bit lane
+        const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+        const __m256i pack = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+        const __m256i m = _mm256_set1_epi64x(static_cast<long long>(mask));
+
+        for (; r + 4 <= n; r += 4) {
+            __m256i v = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(plane + r)), m);
+            __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, lowNibble));
+            __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble));
+            __m256i sums = _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+            __m128i packed = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(sums, pack));
+            __m128i* dst = reinterpret_cast<__m128i*>(counts + r);
+            _mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), packed));
+        }
+#endif
+        for (; r < n; ++r) {
+            counts[r] += static_cast<uint32_t>(__builtin_popcountll(plane[r] & mask));
+        }
+    }
+}
+
+void TagMatrix::build(const std::vector<Row>& rows, size_t tagCount)
+{
+    clear();
+    size_t n = rows.size();
+
+    frequency_.assign(tagCount, 0);
+    for (const Row& row : rows) {
+        for (TagId tag : *row.tags) {
+            if (tag >= frequency_.size()) frequency_.resize(tag + 1, 0);
+            frequency_[tag]++;
+        }
+    }
+    denseSlot_.assign(frequency_.size(), -1);
+    postings_.resize(frequency_.size());
+    for (size_t tag = 0; tag < frequency_.size(); ++tag) {
+        if (isDense(frequency_[tag], n)) {
+            denseSlot_[tag] = static_cast<int32_t>(denseCount_++);
+        } else {
+            postings_[tag].reserve(frequency_[tag]);
+        }
+    }
+
+    reserveRows(n);
+    nodeIds_.resize(n);
+    rowTags_.resize(n);
+    rowOf_.reserve(n);
+    for (size_t r = 0; r < n; ++r) {
+        nodeIds_[r] = rows[r].nodeId;
+        rowOf_[rows[r].nodeId] = static_cast<uint32_t>(r);
+        setRow(r, *rows[r].tags);
+    }
+    builtRows_ = n;
+}
+
+void TagMatrix::clear()
+{
+    stride_ = 0;
+    denseCount_ = 0;
+    planes_.clear();
+    denseSlot_.clear();
+    postings_.clear();
+    frequency_.clear();
+    rowTags_.clear();
+    nodeIds_.clear();
+    rowOf_.clear();
+    builtRows_ = 0;
+    removed_ = 0;
+    misplaced_ = 0;
+}
+
+void TagMatrix::update(uint32_t nodeId, const std::vector<TagId>& tags)
+{
+    size_t row;
+    auto it = rowOf_.find(nodeId);
+    if (it == rowOf_.end()) {
+        row = rows();
+        reserveRows(row + 1);
+        nodeIds_.push_back(nodeId);
+        rowTags_.emplace_back();
+        rowOf_[nodeId] = static_cast<uint32_t>(row);
+    } else {
+        row = it->second;
+        if (rowTags_[row] == tags) {
+            return;
+        }
+        for (TagId tag : rowTags_[row]) {
+            countTag(tag, -1);
+        }
+        clearRow(row);
+    }
+    for (TagId tag : tags) {
+        countTag(tag, 1);
+    }
+    setRow(row, tags);
+}
+
+void TagMatrix::remove(uint32_t nodeId)
+{
+    auto it = rowOf_.find(nodeId);
+    if (it == rowOf_.end()) {
+        return;
+    }
+    for (TagId tag : rowTags_[it->second]) {
+        countTag(tag, -1);
+    }
+    clearRow(it->second);
+    rowOf_.erase(it);
+    removed_++;
+}
+
+bool TagMatrix::needsRebuild() const
+{
+    return removed_ * 4 > rows() || rows() > 2 * builtRows_ + 64 || misplaced_ > 64 + denseCount_ / 8;
+}
+
+int TagMatrix::rowOf(uint32_t nodeId) const
+{
+    auto it = rowOf_.find(nodeId);
+    return it != rowOf_.end() ? static_cast<int>(it->second) : -1;
+}
+
+void TagMatrix::scoreAll(const std::vector<TagId>& tags, std::vector<float>& out) const
+{
+    size_t n = rows();
+    out.assign(n, 0.0f);
+    if (tags.empty() || n == 0) {
+        return;
+    }
+
+    // Intersection sizes: rare tags walk their rows, frequent ones are
+    // gathered into one mask per plane and counted plane by plane
+    std::vector<uint32_t> common(n, 0);
+    std::vector<uint64_t> masks(planeCount(), 0);
+    for (TagId tag : tags) {
+        if (tag >= denseSlot_.size()) {
+            continue;
+        }
+        int32_t slot = denseSlot_[tag];
+        if (slot >= 0) {
+            masks[slot / 64] |= 1ULL << (slot % 64);
+        } else {
+            for (uint32_t row : postings_[tag]) {
+                common[row]++;
+            }
+        }
+    }
+    for (size_t p = 0; p < masks.size(); ++p) {
+        if (masks[p]) {
+            andPopcountAccumulate(planes_.data() + p * stride_, masks[p], common.data(), n);
+        }
+    }
+
+    uint32_t queryCount = static_cast<uint32_t>(tags.size());
+    for (size_t r = 0; r < n; ++r) {
+        uint32_t unionSize = queryCount + static_cast<uint32_t>(rowTags_[r].size()) - common[r];
+        out[r] = unionSize ? static_cast<float>(common[r]) / static_cast<float>(unionSize) : 0.0f;
+    }
+}
+
+float TagMatrix::score(size_t a, size_t b) const
+{
+    const auto& left = rowTags_[a];
+    const auto& right = rowTags_[b];
+    uint32_t common = 0;
+    for (size_t i = 0, j = 0; i < left.size() && j < right.size();) {
+        if (left[i] < right[j]) ++i;
+        else if (right[j] < left[i]) ++j;
+        else { ++common; ++i; ++j; }
+    }
+    uint32_t unionSize = static_cast<uint32_t>(left.size() + right.size()) - common;
+    return unionSize ? static_cast<float>(common) / static_cast<float>(unionSize) : 0.0f;
+}
+
+void TagMatrix::reserveRows(size_t rows)
+{
+    if (rows <= stride_) {
+        return;
+    }
+    // Grow by half so appended rows relayout the planes only now and then
+    size_t stride = std::max(rows, stride_ + stride_ / 2);
+    std::vector<uint64_t> planes(planeCount() * stride, 0);
+    for (size_t p = 0; p < planeCount(); ++p) {
+        std::copy(planes_.begin() + p * stride_, planes_.begin() + (p + 1) * stride_, planes.begin() + p * stride);
+    }
+    planes_.swap(planes);
+    stride_ = stride;
+}
+
+void TagMatrix::setRow(size_t row, const std::vector<TagId>& tags)
+{
+    for (TagId tag : tags) {
+        int32_t slot = denseSlot_[tag];
+        if (slot >= 0) {
+            planes_[(slot / 64) * stride_ + row] |= 1ULL << (slot % 64);
+        } else {
+            auto& list = postings_[tag];
+            list.insert(std::lower_bound(list.begin(), list.end(), static_cast<uint32_t>(row)), static_cast<uint32_t>(row));
+        }
+    }
+    rowTags_[row] = tags;
+}
+
+void TagMatrix::clearRow(size_t row)
+{
+    for (TagId tag : rowTags_[row]) {
+        int32_t slot = denseSlot_[tag];
+        if (slot >= 0) {
+            planes_[(slot / 64) * stride_ + row] &= ~(1ULL << (slot % 64));
+        } else {
+            auto& list = postings_[tag];
+            list.erase(std::lower_bound(list.begin(), list.end(), static_cast<uint32_t>(row)));
+        }
+    }
+    rowTags_[row].clear();
+}
+
+void TagMatrix::countTag(TagId tag, int delta)
+{
+    // Tags interned after build() start as row lists
+    if (tag >= frequency_.size()) {
+        frequency_.resize(tag + 1, 0);
+        denseSlot_.resize(tag + 1, -1);
+        postings_.resize(tag + 1);
+    }
+    size_t live = rows() - removed_;
+    bool stored = denseSlot_[tag] >= 0;
+    bool wasMisplaced = isDense(frequency_[tag], live) != stored;
+    frequency_[tag] += delta;
+    bool misplaced = isDense(frequency_[tag], live) != stored;
+    if (misplaced && !wasMisplaced) {
+        misplaced_++;
+    } else if (wasMisplaced && !misplaced && misplaced_ > 0) {
+        misplaced_--;
+    }
+}
@@ -0,0 +1,147 @@
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+
+namespace {
+    thread_local bool insideWorker = false;
+    thread_local bool backgroundThread = false;
+    size_t globalThreads = 0;
+}
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 1; i < threads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::global()
+{
+    static ThreadPool pool(globalThreads);
+    return pool;
+}
+
+void ThreadPool::setGlobalThreads(size_t threads)
+{
+    globalThreads = threads;
+}
+
+ThreadPool& ThreadPool::background()
+{
+    static ThreadPool pool(std::max<size_t>(1, global().size() / 2));
+    return pool;
+}
+
+void ThreadPool::enterBackground()
+{
+    backgroundThread = true;
+}
+
+ThreadPool& ThreadPool::current()
+{
+    return backgroundThread ? background() : global();
+}
+
+void ThreadPool::runMorsels(size_t worker)
+{
+    size_t begin;
+    while ((begin = next_.fetch_add(morsel_)) < n_) {
+        size_t end = std::min(begin + morsel_, n_);
+        try {
+            (*fn_)(begin, end, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) error_ = std::current_exception();
+            next_.store(n_); // Stop handing out morsels
+        }
+    }
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    insideWorker = true;
+    uint64_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || jobId_ != seen; });
+            if (stop_) return;
+            seen = jobId_;
+            if (index >= participants_) continue;
+        }
+
+        runMorsels(index);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pending_ == 0) {
+            done_.notify_one();
+        }
+    }
+}
+
+size_t ThreadPool::parallelFor(size_t n, size_t morsel,
+                               const std::function<void(size_t, size_t, size_t)>& fn,
+                               size_t maxWorkers)
+{
+    if (n == 0) {
+        return 0;
+    }
+    morsel = std::max<size_t>(morsel, 1);
+
+    size_t participants = size();
+    if (maxWorkers > 0) participants = std::min(participants, maxWorkers);
+    participants = std::min(participants, (n + morsel - 1) / morsel);
+
+    // Nested or trivially small loops run on the calling thread
+    if (insideWorker || participants <= 1) {
+        for (size_t begin = 0; begin < n; begin += morsel) {
+            fn(begin, std::min(begin + morsel, n), 0);
+        }
+        return 1;
+    }
+
+    std::lock_guard<std::mutex> run(runMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        n_ = n;
+        morsel_ = morsel;
+        next_.store(0);
+        fn_ = &fn;
+        error_ = nullptr;
+        participants_ = participants;
+        pending_ = participants - 1;
+        ++jobId_;
+    }
+    wake_.notify_all();
+
+    insideWorker = true;
+    runMorsels(0);
+    insideWorker = false;
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] { return pending_ == 0; });
+        fn_ = nullptr;
+        error = error_;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return participants;
+}
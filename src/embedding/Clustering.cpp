@@ -1,4 +1,5 @@
 #include "embedding/Clustering.hpp"
+#include "core/ConnectedComponents.hpp"
 #include <cmath>
 #include <algorithm>
 
@@ -65,42 +66,45 @@ std::unordered_map<int, std::vector<int>> Clustering::buildAdjacencyList(
     return adj;
 }
 
-void Clustering::dfs(int node,
-                     const std::unordered_map<int, std::vector<int>>& adj,
-                     std::unordered_map<int, bool>& visited,
-                     std::vector<int>& component) {
-    visited[node] = true;
-    component.push_back(node);
-
-    auto it = adj.find(node);
-    if (it != adj.end()) {
-        for (int neighbor : it->second) {
-            if (!visited[neighbor]) {
-                dfs(neighbor, adj, visited, component);
-            }
-        }
-    }
-}
-
 std::vector<std::vector<int>> Clustering::findConnectedComponents(
     const std::unordered_map<int, std::vector<int>>& adjacencyList,
     const std::vector<int>& allNodeIds
 ) {
-    std::vector<std::vector<int>> components;
-    std::unordered_map<int, bool> visited;
-
+    // Dense vertex per id: allNodeIds first, then ids only seen as neighbors
+    std::vector<int> ids;
+    std::unordered_map<int, uint32_t> vertexOf;
+    auto vertex = [&](int id) {
+        auto [it, inserted] = vertexOf.emplace(id, static_cast<uint32_t>(ids.size()));
+        if (inserted) ids.push_back(id);
+        return it->second;
+    };
     for (int id : allNodeIds) {
-        visited[id] = false;
+        vertex(id);
     }
+    size_t seeded = ids.size();
 
-    for (int id : allNodeIds) {
-        if (!visited[id]) {
-            std::vector<int> component;
-            dfs(id, adjacencyList, visited, component);
-            if (!component.empty()) {
-                components.push_back(std::move(component));
-            }
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    for (const auto& [id, neighbors] : adjacencyList) {
+        uint32_t v = vertex(id);
+        for (int neighbor : neighbors) {
+            edges.emplace_back(v, vertex(neighbor));
+        }
+    }
+
+    std::vector<uint32_t> labels = ConnectedComponents::fromEdges(ids.size(), edges);
+
+    // Label = smallest vertex of the component, i.e. its first id in input order.
+    // Components without any of allNodeIds are left out.
+    std::vector<std::vector<int>> components;
+    std::vector<int> componentOf(ids.size(), -1);
+    for (uint32_t v = 0; v < ids.size(); ++v) {
+        uint32_t root = labels[v];
+        if (root >= seeded) continue;
+        if (componentOf[root] < 0) {
+            componentOf[root] = static_cast<int>(components.size());
+            components.emplace_back();
         }
+        components[componentOf[root]].push_back(ids[v]);
     }
 
     return components;
@@ -63,20 +63,23 @@ bool EmbeddingService::generateEmbedding(int nodeId, const std::string& storageP
 
 int EmbeddingService::generateMissingEmbeddings(const std::string& storagePath) {
     int count = 0;
-    auto allNodes = db_.getAllNodes();
-
-    for (const auto& nodeJson : allNodes) {
-        Node node(nodeJson);
-        if (!node.hasEmbedding()) {
-            std::string text = buildTextForEmbedding(node, storagePath);
-            auto embedding = client_.getEmbedding(text);
-
-            if (embedding) {
-                node.setEmbedding(*embedding);
-                db_.updateNode(std::to_string(node.getId()), node.to_json());
-                count++;
-                std::cout << "Generated embedding for node " << node.getId() << std::endl;
-            }
+    std::vector<int> missing;
+    db_.getEmbeddings(&missing);
+
+    for (int id : missing) {
+        std::string idStr = std::to_string(id);
+        if (!db_.exists(idStr)) {
+            continue;
+        }
+        Node node = db_.find(idStr);
+        std::string text = buildTextForEmbedding(node, storagePath);
+        auto embedding = client_.getEmbedding(text);
+
+        if (embedding) {
+            node.setEmbedding(*embedding);
+            db_.updateNode(idStr, node.to_json());
+            count++;
+            std::cout << "Generated embedding for node " << id << std::endl;
         }
     }
 
@@ -84,81 +87,39 @@ int EmbeddingService::generateMissingEmbeddings(const std::string& storagePath)
 }
 
 int EmbeddingService::updateLinks(float threshold) {
-    auto allNodes = db_.getAllNodes();
-
     // Collect embeddings
     std::unordered_map<int, std::vector<float>> embeddings;
-    std::vector<int> nodeIds;
-
-    for (const auto& nodeJson : allNodes) {
-        Node node(nodeJson);
-        if (node.hasEmbedding()) {
-            embeddings[node.getId()] = node.getEmbedding();
-            nodeIds.push_back(node.getId());
-        }
+    for (const auto& [id, embedding] : db_.getEmbeddings()) {
+        embeddings[id] = *embedding;
     }
 
     if (embeddings.size() < 2) {
         return 0;
     }
 
-    // Find similar pairs
-    auto pairs = Clustering::findSimilarPairs(embeddings, threshold);
-    auto adjacencyList = Clustering::buildAdjacencyList(pairs);
-
-    // Update LinkedNodes for each node
-    int linksCreated = 0;
-    for (const auto& nodeJson : allNodes) {
-        Node node(nodeJson);
-        int id = node.getId();
-        auto it = adjacencyList.find(id);
-
-        if (it != adjacencyList.end()) {
-            std::vector<int> newLinks = it->second;
-            std::vector<int> oldLinks = node.getLinkedNodes();
-
-            // Merge old and new links (keep unique)
-            for (int oldLink : oldLinks) {
-                if (std::find(newLinks.begin(), newLinks.end(), oldLink) == newLinks.end()) {
-                    newLinks.push_back(oldLink);
-                }
-            }
-
-            int newLinksCount = newLinks.size() - oldLinks.size();
-            if (newLinksCount > 0) {
-                linksCreated += newLinksCount;
-            }
-
-            node.setLinkedNodes(newLinks);
-            db_.updateNode(std::to_string(id), node.to_json());
-        }
+    // Find similar pairs; existing links of any type are kept
+    std::vector<WeightedLink> links;
+    for (const auto& [a, b, similarity] : Clustering::findSimilarPairs(embeddings, threshold)) {
+        links.push_back({a, b, similarity});
     }
-
-    return linksCreated;
+    return db_.addLinks(links, EDGE_EMBEDDING);
 }
 
 ClusteringResult EmbeddingService::runClustering(const std::string& storagePath, float threshold) {
     ClusteringResult result;
 
-    auto allNodes = db_.getAllNodes();
-    result.nodesProcessed = allNodes.size();
+    result.nodesProcessed = db_.countNodes();
 
     // Generate missing embeddings
     result.embeddingsGenerated = generateMissingEmbeddings(storagePath);
 
-    // Reload nodes after embedding generation
-    allNodes = db_.getAllNodes();
-
-    // Collect embeddings
+    // Collect embeddings, including the ones just generated
     std::unordered_map<int, std::vector<float>> embeddings;
     std::vector<int> nodeIds;
 
-    for (const auto& nodeJson : allNodes) {
-        Node node(nodeJson);
-        if (node.hasEmbedding()) {
-            embeddings[node.getId()] = node.getEmbedding();
-            nodeIds.push_back(node.getId());
-        }
+    for (const auto& [id, embedding] : db_.getEmbeddings()) {
+        embeddings[id] = *embedding;
+        nodeIds.push_back(id);
     }
 
     if (embeddings.size() < 2) {
@@ -173,21 +134,14 @@ ClusteringResult EmbeddingService::runClustering(const std::string& storagePath,
     result.clusters = Clustering::findConnectedComponents(adjacencyList, nodeIds);
     result.clustersFound = result.clusters.size();
 
-    // Update LinkedNodes
-    for (const auto& nodeJson : allNodes) {
-        Node node(nodeJson);
-        int id = node.getId();
-        auto it = adjacencyList.find(id);
-
-        if (it != adjacencyList.end()) {
-            node.setLinkedNodes(it->second);
-            db_.updateNode(std::to_string(id), node.to_json());
-            result.linksCreated += it->second.size();
-        }
+    // This run's pairs become the embedding links; tag and manual links stay
+    std::vector<WeightedLink> links;
+    for (const auto& [a, b, similarity] : pairs) {
+        links.push_back({a, b, similarity});
     }
-
-    // Links are bidirectional, so divide by 2
-    result.linksCreated /= 2;
+    auto [created, removed] = db_.replaceLinks(links, EDGE_EMBEDDING);
+    result.linksCreated = created;
+    result.linksRemoved = removed;
 
     return result;
 }
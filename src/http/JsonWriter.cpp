@@ -0,0 +1,168 @@
+#include "http/JsonWriter.hpp"
+#include <charconv>
+#include <cmath>
+
+namespace whisperdb {
+namespace http {
+
+JsonWriter::JsonWriter(std::string& buffer, Sink sink, size_t flushThreshold)
+    : buffer_(buffer), sink_(std::move(sink)), threshold_(flushThreshold)
+{
+    buffer_.clear();
+}
+
+void JsonWriter::separator()
+{
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (!first_.empty()) {
+        if (!first_.back()) buffer_ += ',';
+        first_.back() = false;
+    }
+}
+
+void JsonWriter::beginObject()
+{
+    separator();
+    buffer_ += '{';
+    first_.push_back(true);
+}
+
+void JsonWriter::endObject()
+{
+    buffer_ += '}';
+    first_.pop_back();
+    maybeFlush();
+}
+
+void JsonWriter::beginArray()
+{
+    separator();
+    buffer_ += '[';
+    first_.push_back(true);
+}
+
+void JsonWriter::endArray()
+{
+    buffer_ += ']';
+    first_.pop_back();
+    maybeFlush();
+}
+
+void JsonWriter::key(std::string_view name)
+{
+    separator();
+    writeString(name);
+    buffer_ += ':';
+    afterKey_ = true;
+}
+
+void JsonWriter::value(std::string_view s)
+{
+    separator();
+    writeString(s);
+    maybeFlush();
+}
+
+void JsonWriter::value(int64_t v)
+{
+    separator();
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    buffer_.append(buf, res.ptr);
+}
+
+void JsonWriter::value(uint64_t v)
+{
+    separator();
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    buffer_.append(buf, res.ptr);
+}
+
+void JsonWriter::value(double v)
+{
+    separator();
+    if (!std::isfinite(v)) {
+        buffer_ += "null";
+        return;
+    }
+    // Shortest round-trip form; integral values keep a ".0" like nlohmann
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    std::string_view text(buf, static_cast<size_t>(res.ptr - buf));
+    buffer_ += text;
+    if (text.find_first_of(".e") == std::string_view::npos) {
+        buffer_ += ".0";
+    }
+}
+
+void JsonWriter::value(bool v)
+{
+    separator();
+    buffer_ += v ? "true" : "false";
+}
+
+void JsonWriter::null()
+{
+    separator();
+    buffer_ += "null";
+}
+
+void JsonWriter::value(const nlohmann::json& j)
+{
+    raw(j.dump());
+}
+
+void JsonWriter::raw(std::string_view encoded)
+{
+    separator();
+    buffer_ += encoded;
+    maybeFlush();
+}
+
+void JsonWriter::writeString(std::string_view s)
+{
+    static const char* hex = "0123456789abcdef";
+
+    buffer_ += '"';
+    size_t run = 0; // Start of the pending unescaped span
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        buffer_.append(s.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':  buffer_ += "\\\""; break;
+            case '\\': buffer_ += "\\\\"; break;
+            case '\b': buffer_ += "\\b"; break;
+            case '\f': buffer_ += "\\f"; break;
+            case '\n': buffer_ += "\\n"; break;
+            case '\r': buffer_ += "\\r"; break;
+            case '\t': buffer_ += "\\t"; break;
+            default:
+                buffer_ += "\\u00";
+                buffer_ += hex[c >> 4];
+                buffer_ += hex[c & 0xF];
+        }
+    }
+    buffer_.append(s.data() + run, s.size() - run);
+    buffer_ += '"';
+}
+
+void JsonWriter::flush()
+{
+    if (!sink_ || buffer_.empty()) {
+        return;
+    }
+    sink_(buffer_.data(), buffer_.size());
+    written_ += buffer_.size();
+    buffer_.clear(); // Keeps capacity for the next chunk
+}
+
+} // namespace http
+} // namespace whisperdb
@@ -4,6 +4,9 @@
 #include <nlohmann/json.hpp>
 
 #include "core/GraphDB.hpp"
+#include "core/ThreadPool.hpp"
+#include "core/GraphTraversal.hpp"
+#include "config.hpp"
 #include "server/wserver.hpp"
 #include "server/endpoint.hpp"
 #include "server/UploadHandler.hpp"
@@ -13,17 +16,146 @@
 #include "embedding/Clustering.hpp"
 #include "tagging/TagService.hpp"
 #include <algorithm>
+#include <cmath>
 
 using json = nlohmann::json;
 using whisperdb::http::Request;
 using whisperdb::http::Response;
 using whisperdb::http::MultipartPart;
+using whisperdb::http::JsonWriter;
 
 std::shared_ptr<GraphDB> db;
 std::unique_ptr<EmbeddingService> embeddingService;
 std::unique_ptr<TagService> tagService;
 const std::string STORAGE_PATH = "./storage";
 
+// Collect supported filters from the query string and validate range bounds
+bool extractFilters(const Request& req, std::unordered_map<std::string, std::string>& filters, std::string& error) {
+    for (const auto& [key, value] : req.query) {
+        if (key == "subject" || key == "author" || key == "course" ||
+            key == "title" || key == "tag" || key == "community") {
+            filters[key] = value;
+        } else if (key == "course_min" || key == "course_max") {
+            try {
+                std::stoi(value);
+            } catch (...) {
+                error = "Invalid " + key + " parameter";
+                return false;
+            }
+            filters[key] = value;
+        } else if (key == "date_from" || key == "date_to") {
+            if (!Node::parseDate(value)) {
+                error = "Invalid " + key + " parameter (expected YYYY-MM-DD[ HH:MM[:SS]])";
+                return false;
+            }
+            filters[key] = value;
+        }
+    }
+    return true;
+}
+
+// Parse ?fields= projection; embeddings are left out unless asked for
+bool extractFields(const Request& req, uint32_t& fields, std::string& error,
+                   uint32_t defaultFields = Node::DEFAULT_FIELDS) {
+    fields = defaultFields;
+    if (!req.hasQuery("fields")) {
+        return true;
+    }
+    auto parsed = Node::parseFields(req.getQuery("fields"));
+    if (!parsed || *parsed == 0) {
+        error = "Invalid fields parameter";
+        return false;
+    }
+    fields = *parsed;
+    return true;
+}
+
+// Graph traversal responses carry edges separately, so nodes default to a short projection
+const uint32_t TRAVERSAL_FIELDS = FIELD_ID | FIELD_TITLE | FIELD_SUBJECT | FIELD_TAGS;
+
+// Parse ?min_weight= and ?types=manual,tag,embedding for graph traversal and ranking
+bool extractEdgeFilter(const Request& req, EdgeFilter& filter, std::string& error) {
+    filter = EdgeFilter{};
+    try {
+        if (req.hasQuery("min_weight")) {
+            filter.minWeight = std::stof(req.getQuery("min_weight"));
+        }
+    } catch (...) {
+        error = "Invalid min_weight parameter";
+        return false;
+    }
+    if (req.hasQuery("types")) {
+        filter.types = EdgeStore::parseTypes(req.getQuery("types"));
+        if (filter.types == 0) {
+            error = "Invalid types parameter (use manual, tag, embedding)";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Parse ?score=adamic_adar|jaccard|resource_allocation, ?limit= (per node) and edge filters
+bool extractLinkPrediction(const Request& req, LinkPrediction::Options& options, std::string& error) {
+    options = LinkPrediction::Options{};
+    if (req.hasQuery("score") && !LinkPrediction::parseScore(req.getQuery("score"), options.score)) {
+        error = "Invalid score parameter (use adamic_adar, jaccard, resource_allocation)";
+        return false;
+    }
+    try {
+        if (req.hasQuery("limit")) {
+            int value = std::stoi(req.getQuery("limit"));
+            if (value <= 0) throw std::invalid_argument("limit");
+            options.limit = static_cast<size_t>(value);
+        }
+    } catch (...) {
+        error = "Invalid limit parameter";
+        return false;
+    }
+    return extractEdgeFilter(req, options.filter, error);
+}
+
+// Parse ?limit= and ?min_count= for tag ranking endpoints
+bool extractTagRankParams(const Request& req, size_t& limit, uint32_t& minCount, std::string& error) {
+    limit = 10;
+    minCount = 1;
+    try {
+        if (req.hasQuery("limit")) {
+            int value = std::stoi(req.getQuery("limit"));
+            if (value <= 0) throw std::invalid_argument("limit");
+            limit = static_cast<size_t>(value);
+        }
+    } catch (...) {
+        error = "Invalid limit parameter";
+        return false;
+    }
+    try {
+        if (req.hasQuery("min_count")) {
+            int value = std::stoi(req.getQuery("min_count"));
+            if (value <= 0) throw std::invalid_argument("min_count");
+            minCount = static_cast<uint32_t>(value);
+        }
+    } catch (...) {
+        error = "Invalid min_count parameter";
+        return false;
+    }
+    return true;
+}
+
+json tagScoresToJson(const std::vector<TagScore>& scores) {
+    const TagDictionary& dictionary = db->getTagDictionary();
+    json result = json::array();
+    for (const auto& score : scores) {
+        result.push_back({
+            {"tag", dictionary.name(score.tag)},
+            {"count", score.count},
+            {"usage", dictionary.usage(score.tag)},
+            {"pmi", score.pmi},
+            {"lift", score.lift}
+        });
+    }
+    return result;
+}
+
 void signal_handler(int signum) {
     if (signum == SIGINT) {
         std::cout << "\nSIGINT received, saving database..." << std::endl;
@@ -36,7 +168,15 @@ void signal_handler(int signum) {
 
 int main()
 {
+    // Scan worker pool size, must be set before the pool is first used
+    size_t scanThreads = SCAN_THREADS;
+    if (const char* env = std::getenv("WHISPERDB_SCAN_THREADS")) {
+        scanThreads = static_cast<size_t>(std::strtoul(env, nullptr, 10));
+    }
+    ThreadPool::setGlobalThreads(scanThreads);
+
     db = std::make_shared<GraphDB>();
+    db->setScanThreads(scanThreads);
     std::signal(SIGINT, signal_handler);
 
     // Initialize embedding service if API key is set
@@ -62,7 +202,8 @@ int main()
 
     // ============================================
     // GET /api/nodes - List all nodes with optional filters, sorting, and pagination
-    // Query params: subject, author, course, title, tag, sort, order, limit, offset
+    // Query params: subject, author, course, title, tag, course_min, course_max,
+    //               date_from, date_to, sort, order, limit, offset, fields, explain=1
     // ============================================
     endpoint get_nodes(
         [](const Request& req) -> Response {
@@ -70,11 +211,9 @@ int main()
 
             // Extract filters
             std::unordered_map<std::string, std::string> filters;
-            for (const auto& [key, value] : req.query) {
-                if (key == "subject" || key == "author" || key == "course" ||
-                    key == "title" || key == "tag") {
-                    filters[key] = value;
-                }
+            std::string filterError;
+            if (!extractFilters(req, filters, filterError)) {
+                return Response::badRequest(filterError);
             }
 
             // Extract sorting parameters
@@ -101,25 +240,50 @@ int main()
                 }
             }
 
-            // Get nodes with filtering, sorting, and pagination
-            json nodes;
-            if (filters.empty()) {
-                nodes = db->getAllNodes(sortBy, order, limit, offset);
-            } else {
-                nodes = db->findNodes(filters, sortBy, order, limit, offset);
+            uint32_t fields;
+            std::string fieldsError;
+            if (!extractFields(req, fields, fieldsError)) {
+                return Response::badRequest(fieldsError);
             }
 
-            response["status"] = "success";
-            response["count"] = nodes.size();
-            response["nodes"] = nodes;
+            // EXPLAIN goes through the buffered path, it needs the serialize timing
+            if (req.getQuery("explain") == "1") {
+                json plan;
+                json nodes = db->findNodes(filters, sortBy, order, limit, offset, fields, &plan);
 
-            // Add metadata for pagination
-            if (limit > 0) {
-                response["limit"] = limit;
-                response["offset"] = offset;
+                response["status"] = "success";
+                response["count"] = nodes.size();
+                response["nodes"] = nodes;
+                response["explain"] = plan;
+                if (limit > 0) {
+                    response["limit"] = limit;
+                    response["offset"] = offset;
+                }
+                return Response::ok(response.dump());
             }
 
-            return Response::ok(response.dump());
+            // Get nodes with filtering, sorting, and pagination; each node's cached
+            // JSON fragment is copied straight into the socket buffer
+            auto page = db->queryNodes(filters, sortBy, order, limit, offset);
+
+            return Response::streamed([page = std::move(page), fields, limit, offset](JsonWriter& out) {
+                out.beginObject();
+                out.key("count"); out.value(static_cast<uint64_t>(page.size()));
+                if (limit > 0) {
+                    out.key("limit"); out.value(limit);
+                }
+                out.key("nodes");
+                out.beginArray();
+                for (const Node* node : page) {
+                    out.raw(node->jsonFragment(fields));
+                }
+                out.endArray();
+                if (limit > 0) {
+                    out.key("offset"); out.value(offset);
+                }
+                out.key("status"); out.value("success");
+                out.endObject();
+            });
         },
         HttpRequest::GET,
         "/api/nodes"
@@ -128,17 +292,16 @@ int main()
 
     // ============================================
     // GET /api/nodes/count - Count nodes with optional filters
-    // Query params: subject, author, course, title, tag (same as /api/nodes)
+    // Query params: subject, author, course, title, tag, course_min, course_max,
+    //               date_from, date_to (same as /api/nodes)
     // ============================================
     endpoint count_nodes(
         [](const Request& req) -> Response {
             // Extract filters (same logic as get_nodes)
             std::unordered_map<std::string, std::string> filters;
-            for (const auto& [key, value] : req.query) {
-                if (key == "subject" || key == "author" || key == "course" ||
-                    key == "title" || key == "tag") {
-                    filters[key] = value;
-                }
+            std::string filterError;
+            if (!extractFilters(req, filters, filterError)) {
+                return Response::badRequest(filterError);
             }
 
             int count = db->countNodes(filters);
@@ -154,8 +317,40 @@ int main()
     );
     server->add_endpoint(count_nodes);
 
+    // ============================================
+    // GET /api/facets - Counts per subject, author, course and tag
+    // Query params: same filters as /api/nodes, limit (top values per facet)
+    // ============================================
+    endpoint get_facets(
+        [](const Request& req) -> Response {
+            std::unordered_map<std::string, std::string> filters;
+            std::string filterError;
+            if (!extractFilters(req, filters, filterError)) {
+                return Response::badRequest(filterError);
+            }
+
+            int limit = -1;
+            if (req.hasQuery("limit")) {
+                try {
+                    limit = std::stoi(req.getQuery("limit"));
+                } catch (...) {
+                    return Response::badRequest("Invalid limit parameter");
+                }
+            }
+
+            json response = db->getFacets(filters, limit);
+            response["status"] = "success";
+
+            return Response::ok(response.dump());
+        },
+        HttpRequest::GET,
+        "/api/facets"
+    );
+    server->add_endpoint(get_facets);
+
     // ============================================
     // GET /api/nodes/:id - Get single node by ID
+    // Query params: fields (projection, default: all except embedding)
     // ============================================
     endpoint get_node_by_id(
         [](const Request& req) -> Response {
@@ -165,14 +360,23 @@ int main()
                 return Response::notFound("Node not found: " + id);
             }
 
-            try {
-                Node node = db->find(id);
-                json response;
-                response["status"] = "success";
-                response["node"] = node.to_json();
-                response["files"] = db->getNodeFiles(id);
+            uint32_t fields;
+            std::string fieldsError;
+            if (!extractFields(req, fields, fieldsError)) {
+                return Response::badRequest(fieldsError);
+            }
 
-                return Response::ok(response.dump());
+            try {
+                // The node's cached fragment is spliced in as-is
+                std::string body;
+                JsonWriter out(body);
+                out.beginObject();
+                out.key("files"); out.array(db->getNodeFiles(id));
+                out.key("node"); out.raw(db->getNode(id)->jsonFragment(fields));
+                out.key("status"); out.value("success");
+                out.endObject();
+
+                return Response::ok(body);
             } catch (const std::exception& e) {
                 return Response::error(e.what());
             }
@@ -275,11 +479,10 @@ int main()
                 updates.erase("id");
 
                 if (db->updateNode(id, updates)) {
-                    Node node = db->find(id);
                     json response;
                     response["status"] = "success";
                     response["message"] = "Node updated";
-                    response["node"] = node.to_json();
+                    response["node"] = db->getNodeJson(id, Node::DEFAULT_FIELDS);
 
                     return Response::ok(response.dump());
                 } else {
@@ -397,6 +600,9 @@ int main()
             response["status"] = "ok";
             response["service"] = "TheWhisperDB";
             response["nodes_count"] = db->getSize();
+            response["generation"] = db->getGeneration();
+            response["queryCache"] = db->getQueryCacheStats();
+            response["scanThreads"] = db->getScanThreads();
 
             return Response::ok(response.dump());
         },
@@ -462,6 +668,7 @@ int main()
                 response["nodesProcessed"] = result.nodesProcessed;
                 response["embeddingsGenerated"] = result.embeddingsGenerated;
                 response["linksCreated"] = result.linksCreated;
+                response["linksRemoved"] = result.linksRemoved;
                 response["clustersFound"] = result.clustersFound;
                 response["clusters"] = result.clusters;
 
@@ -513,7 +720,7 @@ int main()
 
     // ============================================
     // GET /api/nodes/:id/similar - Get similar nodes
-    // Query params: limit (default: 10)
+    // Query params: limit (default: 10), fields
     // ============================================
     endpoint get_similar_nodes(
         [](const Request& req) -> Response {
@@ -536,15 +743,19 @@ int main()
                     } catch (...) {}
                 }
 
-                // Get all nodes with embeddings and calculate similarity
-                auto allNodes = db->getAllNodes();
+                uint32_t fields;
+                std::string fieldsError;
+                if (!extractFields(req, fields, fieldsError)) {
+                    return Response::badRequest(fieldsError);
+                }
+
+                // Compare against the embeddings held by the nodes
                 std::vector<std::pair<std::string, float>> similarities;
 
-                for (const auto& otherJson : allNodes) {
-                    Node other(otherJson);
-                    if (other.getId() != node.getId() && other.hasEmbedding()) {
-                        float sim = Clustering::cosineSimilarity(node.getEmbedding(), other.getEmbedding());
-                        similarities.emplace_back(std::to_string(other.getId()), sim);
+                for (const auto& [otherId, embedding] : db->getEmbeddings()) {
+                    if (otherId != node.getId()) {
+                        float sim = Clustering::cosineSimilarity(node.getEmbedding(), *embedding);
+                        similarities.emplace_back(std::to_string(otherId), sim);
                     }
                 }
 
@@ -555,8 +766,7 @@ int main()
                 // Take top N
                 json similarNodes = json::array();
                 for (int i = 0; i < std::min(limit, (int)similarities.size()); ++i) {
-                    Node similarNode = db->find(similarities[i].first);
-                    json nodeJson = similarNode.to_json();
+                    json nodeJson = db->getNodeJson(similarities[i].first, fields);
                     nodeJson["similarity"] = similarities[i].second;
                     similarNodes.push_back(nodeJson);
                 }
@@ -601,6 +811,13 @@ int main()
                     response["tags"] = result.generatedTags;
                     response["newTagsAdded"] = result.newTagsAdded;
                     response["linkedNodes"] = result.linkedNodeIds;
+                    response["prompt"] = {
+                        {"bankSize", result.bankSize},
+                        {"bankTags", result.prompt.bankTags},
+                        {"systemBytes", result.prompt.systemBytes},
+                        {"userBytes", result.prompt.userBytes},
+                        {"promptTokens", result.prompt.promptTokens}
+                    };
                     return Response::ok(response.dump());
                 } else {
                     return Response::error(result.error);
@@ -619,10 +836,20 @@ int main()
     // ============================================
     endpoint get_tag_bank(
         [](const Request&) -> Response {
+            const auto& tagBank = db->getTagBank();
+            const TagDictionary& dictionary = db->getTagDictionary();
+
+            // Number of nodes carrying each bank tag
+            json usage = json::object();
+            for (const auto& tag : tagBank) {
+                usage[tag] = dictionary.usage(dictionary.find(tag));
+            }
+
             json response;
             response["status"] = "success";
-            response["tagBank"] = db->getTagBank();
-            response["count"] = db->getTagBank().size();
+            response["tagBank"] = tagBank;
+            response["count"] = tagBank.size();
+            response["usage"] = usage;
             return Response::ok(response.dump());
         },
         HttpRequest::GET,
@@ -630,37 +857,158 @@ int main()
     );
     server->add_endpoint(get_tag_bank);
 
+    // ============================================
+    // GET /api/tags/complete - Autocomplete tag bank entries by prefix
+    // Query params: prefix (default: empty = most used tags), limit (default: 10)
+    // ============================================
+    endpoint complete_tags(
+        [](const Request& req) -> Response {
+            std::string prefix = req.getQuery("prefix");
+
+            size_t limit = 10;
+            if (req.hasQuery("limit")) {
+                try {
+                    int value = std::stoi(req.getQuery("limit"));
+                    if (value <= 0) throw std::invalid_argument("limit");
+                    limit = static_cast<size_t>(value);
+                } catch (...) {
+                    return Response::badRequest("Invalid limit parameter");
+                }
+            }
+
+            size_t matches = 0;
+            json completions = json::array();
+            for (const auto& entry : db->completeTags(prefix, limit, &matches)) {
+                completions.push_back({{"tag", entry.name}, {"usage", entry.weight}});
+            }
+
+            json response;
+            response["status"] = "success";
+            response["prefix"] = prefix;
+            response["matches"] = matches;
+            response["completions"] = completions;
+            return Response::ok(response.dump());
+        },
+        HttpRequest::GET,
+        "/api/tags/complete"
+    );
+    server->add_endpoint(complete_tags);
+
     // ============================================
     // GET /api/tags/:tag/nodes - Get nodes with a specific tag
+    // Query params: fields
     // ============================================
     endpoint get_nodes_by_tag(
         [](const Request& req) -> Response {
             std::string tag = req.getParam("tag");
-            auto nodeIds = db->findNodesByTag(tag);
 
-            json nodes = json::array();
-            for (int id : nodeIds) {
-                std::string idStr = std::to_string(id);
-                if (db->exists(idStr)) {
-                    nodes.push_back(db->find(idStr).to_json());
+            uint32_t fields;
+            std::string fieldsError;
+            if (!extractFields(req, fields, fieldsError)) {
+                return Response::badRequest(fieldsError);
+            }
+
+            std::vector<const Node*> nodes;
+            for (int id : db->findNodesByTag(tag)) {
+                if (const Node* node = db->getNode(std::to_string(id))) {
+                    nodes.push_back(node);
                 }
             }
 
+            return Response::streamed([nodes = std::move(nodes), tag, fields](JsonWriter& out) {
+                out.beginObject();
+                out.key("count"); out.value(static_cast<uint64_t>(nodes.size()));
+                out.key("nodes");
+                out.beginArray();
+                for (const Node* node : nodes) {
+                    out.raw(node->jsonFragment(fields));
+                }
+                out.endArray();
+                out.key("status"); out.value("success");
+                out.key("tag"); out.value(tag);
+                out.endObject();
+            });
+        },
+        HttpRequest::GET,
+        "/api/tags/:tag/nodes"
+    );
+    server->add_endpoint(get_nodes_by_tag);
+
+    // ============================================
+    // GET /api/tags/:tag/related - Tags that co-occur with a tag
+    // Query params: limit (default: 10), min_count (default: 1)
+    // ============================================
+    endpoint get_related_tags(
+        [](const Request& req) -> Response {
+            std::string tag = req.getParam("tag");
+
+            size_t limit;
+            uint32_t minCount;
+            std::string paramError;
+            if (!extractTagRankParams(req, limit, minCount, paramError)) {
+                return Response::badRequest(paramError);
+            }
+
+            const TagDictionary& dictionary = db->getTagDictionary();
+            TagId id = dictionary.find(tag);
+            if (id == TagDictionary::NO_TAG || dictionary.usage(id) == 0) {
+                return Response::notFound("Tag not found: " + tag);
+            }
+
             json response;
             response["status"] = "success";
             response["tag"] = tag;
-            response["nodes"] = nodes;
-            response["count"] = nodes.size();
+            response["usage"] = dictionary.usage(id);
+            response["related"] = tagScoresToJson(db->relatedTags(tag, limit, minCount));
             return Response::ok(response.dump());
         },
         HttpRequest::GET,
-        "/api/tags/:tag/nodes"
+        "/api/tags/:tag/related"
     );
-    server->add_endpoint(get_nodes_by_tag);
+    server->add_endpoint(get_related_tags);
+
+    // ============================================
+    // GET /api/tags/suggest - Next tags for a partially tagged node
+    // Query params: tags (comma-separated, required), limit (default: 10), min_count (default: 1)
+    // ============================================
+    endpoint suggest_tags(
+        [](const Request& req) -> Response {
+            if (!req.hasQuery("tags")) {
+                return Response::badRequest("Missing tags parameter");
+            }
+
+            size_t limit;
+            uint32_t minCount;
+            std::string paramError;
+            if (!extractTagRankParams(req, limit, minCount, paramError)) {
+                return Response::badRequest(paramError);
+            }
+
+            std::vector<std::string> tags;
+            std::string list = req.getQuery("tags");
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t end = list.find(',', start);
+                if (end == std::string::npos) end = list.size();
+                if (end > start) tags.push_back(list.substr(start, end - start));
+                start = end + 1;
+            }
+
+            json response;
+            response["status"] = "success";
+            response["tags"] = tags;
+            response["suggestions"] = tagScoresToJson(db->suggestTags(tags, limit, minCount));
+            return Response::ok(response.dump());
+        },
+        HttpRequest::GET,
+        "/api/tags/suggest"
+    );
+    server->add_endpoint(suggest_tags);
 
     // ============================================
     // POST /api/tags/link-all - Batch update all tag-based links
-    // Query params: threshold (Jaccard similarity, default: 0.3)
+    // Query params: threshold (Jaccard similarity, default: 0.3),
+    //               recall=1 (also run the exact all-pairs scan and report LSH recall)
     // ============================================
     endpoint update_tag_links(
         [](const Request& req) -> Response {
@@ -680,12 +1028,23 @@ int main()
                 }
             }
 
-            int linksCreated = tagService->updateAllTagBasedLinks(threshold);
+            bool recall = req.getQuery("recall") == "1";
+            LinkAllResult result = tagService->updateAllTagBasedLinks(threshold, recall);
 
             json response;
             response["status"] = "success";
-            response["linksCreated"] = linksCreated;
+            response["linksCreated"] = result.linksCreated;
             response["threshold"] = threshold;
+            response["nodesWithTags"] = result.nodesWithTags;
+            response["lsh"] = {{"bands", result.bands}, {"rows", result.rows}};
+            response["candidatePairs"] = result.candidatePairs;
+            response["similarPairs"] = result.similarPairs;
+            response["elapsedMs"] = result.elapsedMs;
+            if (result.recallMeasured) {
+                response["exactPairs"] = result.exactPairs;
+                response["recall"] = result.recall;
+                response["exactMs"] = result.exactMs;
+            }
             return Response::ok(response.dump());
         },
         HttpRequest::POST,
@@ -693,6 +1052,369 @@ int main()
     );
     server->add_endpoint(update_tag_links);
 
+    // ============================================
+    // GET /api/nodes/:id/links - Direct links of a node with type, weight and time
+    // Query params: min_weight, types (comma-separated: manual, tag, embedding)
+    // ============================================
+    endpoint get_node_links(
+        [](const Request& req) -> Response {
+            std::string idStr = req.getParam("id");
+            if (!db->exists(idStr)) {
+                return Response::notFound("Node not found: " + idStr);
+            }
+            EdgeFilter filter;
+            std::string filterError;
+            if (!extractEdgeFilter(req, filter, filterError)) {
+                return Response::badRequest(filterError);
+            }
+
+            int id = std::stoi(idStr);
+            const CsrGraph& graph = db->getLinkGraph();
+            int vertex = graph.vertexOf(static_cast<uint32_t>(id));
+
+            json links = json::array();
+            for (uint64_t e = graph.edgeBegin(static_cast<uint32_t>(vertex)); e < graph.edgeEnd(static_cast<uint32_t>(vertex)); ++e) {
+                if (!graph.accepts(e, filter)) continue;
+                int other = static_cast<int>(graph.nodeId(graph.target(e)));
+                links.push_back({
+                    {"id", other},
+                    {"types", EdgeStore::typeNames(graph.edgeTypes(e))},
+                    {"weight", graph.weight(e)},
+                    {"timestamp", db->getEdge(id, other).timestamp}
+                });
+            }
+
+            json response;
+            response["status"] = "success";
+            response["nodeId"] = id;
+            response["count"] = links.size();
+            response["links"] = links;
+            return Response::ok(response.dump());
+        },
+        HttpRequest::GET,
+        "/api/nodes/:id/links"
+    );
+    server->add_endpoint(get_node_links);
+
+    // ============================================
+    // GET /api/nodes/:id/suggested-links - Nodes worth linking to, by common neighbors
+    // Query params: score (adamic_adar, jaccard, resource_allocation; default: adamic_adar),
+    //               limit (default: 10), min_weight, types
+    // ============================================
+    endpoint get_suggested_links(
+        [](const Request& req) -> Response {
+            std::string idStr = req.getParam("id");
+            if (!db->exists(idStr)) {
+                return Response::notFound("Node not found: " + idStr);
+            }
+            LinkPrediction::Options options;
+            std::string error;
+            if (!extractLinkPrediction(req, options, error)) {
+                return Response::badRequest(error);
+            }
+
+            LinkPrediction::Result result = db->suggestLinks(std::stoi(idStr), options);
+            const CsrGraph& graph = db->getLinkGraph();
+            json suggestions = json::array();
+            for (const auto& suggestion : result.suggestions) {
+                int other = static_cast<int>(graph.nodeId(suggestion.vertex));
+                const Node* node = db->getNode(std::to_string(other));
+                suggestions.push_back({
+                    {"id", other},
+                    {"score", suggestion.score},
+                    {"common", suggestion.common},
+                    {"title", node ? node->getTitle() : ""}
+                });
+            }
+
+            json response;
+            response["status"] = "success";
+            response["nodeId"] = std::stoi(idStr);
+            response["score"] = LinkPrediction::scoreName(options.score);
+            response["paths"] = result.paths;
+            response["truncated"] = result.truncated;
+            response["suggestions"] = suggestions;
+            return Response::ok(response.dump());
+        },
+        HttpRequest::GET,
+        "/api/nodes/:id/suggested-links"
+    );
+    server->add_endpoint(get_suggested_links);
+
+    // ============================================
+    // GET /api/links/suggested - Suggested links of every node (batch, cached until links change)
+    // Query params: score, limit (per node, default: 10), min_weight, types,
+    //               page (nodes per page, default: 100), offset (default: 0)
+    // ============================================
+    endpoint get_all_suggested_links(
+        [](const Request& req) -> Response {
+            LinkPrediction::Options options;
+            std::string error;
+            if (!extractLinkPrediction(req, options, error)) {
+                return Response::badRequest(error);
+            }
+            size_t page = 100, offset = 0;
+            try {
+                if (req.hasQuery("page")) {
+                    int value = std::stoi(req.getQuery("page"));
+                    if (value <= 0) throw std::invalid_argument("page");
+                    page = static_cast<size_t>(value);
+                }
+                if (req.hasQuery("offset")) {
+                    int value = std::stoi(req.getQuery("offset"));
+                    if (value < 0) throw std::invalid_argument("offset");
+                    offset = static_cast<size_t>(value);
+                }
+            } catch (...) {
+                return Response::badRequest("Invalid page or offset parameter");
+            }
+
+            double elapsedMs = 0;
+            const auto& byVertex = db->suggestAllLinks(options, &elapsedMs);
+            const CsrGraph& graph = db->getLinkGraph();
+
+            // Only nodes with something to suggest are paged
+            json nodes = json::array();
+            size_t total = 0;
+            for (uint32_t v = 0; v < byVertex.size(); ++v) {
+                if (byVertex[v].empty()) continue;
+                if (total++ < offset || nodes.size() >= page) continue;
+                json suggestions = json::array();
+                for (const auto& suggestion : byVertex[v]) {
+                    suggestions.push_back({
+                        {"id", graph.nodeId(suggestion.vertex)},
+                        {"score", suggestion.score}
+                    });
+                }
+                nodes.push_back({{"id", graph.nodeId(v)}, {"suggestions", suggestions}});
+            }
+
+            json response;
+            response["status"] = "success";
+            response["score"] = LinkPrediction::scoreName(options.score);
+            response["computedMs"] = elapsedMs;
+            response["total"] = total;
+            response["offset"] = offset;
+            response["nodes"] = nodes;
+            return Response::ok(response.dump());
+        },
+        HttpRequest::GET,
+        "/api/links/suggested"
+    );
+    server->add_endpoint(get_all_suggested_links);
+
+    // ============================================
+    // GET /api/links/check - Result of the last link consistency sweep
+    // ============================================
+    endpoint get_link_check(
+        [](const Request&) -> Response {
+            json response;
+            response["status"] = "success";
+            response["check"] = db->getLinkCheckStatus();
+            return Response::ok(response.dump());
+        },
+        HttpRequest::GET,
+        "/api/links/check"
+    );
+    server->add_endpoint(get_link_check);
+
+    // ============================================
+    // POST /api/links/repair - Run a link consistency sweep
+    // Query params: wait=1 (apply it before responding; otherwise it runs in the background)
+    // ============================================
+    endpoint repair_links(
+        [](const Request& req) -> Response {
+            db->checkLinks(req.getQuery("wait") == "1");
+
+            json response;
+            response["status"] = "success";
+            response["check"] = db->getLinkCheckStatus();
+            return Response::ok(response.dump());
+        },
+        HttpRequest::POST,
+        "/api/links/repair"
+    );
+    server->add_endpoint(repair_links);
+
+    // ============================================
+    // GET /api/nodes/:id/neighborhood - Nodes within k hops, with the links between them
+    // Query params: depth (default: 1), limit (max nodes, default: 200), fields
+    // ============================================
+    endpoint get_neighborhood(
+        [](const Request& req) -> Response {
+            std::string idStr = req.getParam("id");
+            if (!db->exists(idStr)) {
+                return Response::notFound("Node not found: " + idStr);
+            }
+
+            int depth = 1;
+            size_t limit = 200;
+            try {
+                if (req.hasQuery("depth")) {
+                    depth = std::stoi(req.getQuery("depth"));
+                    if (depth < 0) throw std::invalid_argument("depth");
+                }
+            } catch (...) {
+                return Response::badRequest("Invalid depth parameter");
+            }
+            try {
+                if (req.hasQuery("limit")) {
+                    int value = std::stoi(req.getQuery("limit"));
+                    if (value <= 0) throw std::invalid_argument("limit");
+                    limit = static_cast<size_t>(value);
+                }
+            } catch (...) {
+                return Response::badRequest("Invalid limit parameter");
+            }
+            limit = std::min(limit, NEIGHBORHOOD_MAX_NODES);
+
+            uint32_t fields;
+            std::string fieldsError;
+            if (!extractFields(req, fields, fieldsError, TRAVERSAL_FIELDS)) {
+                return Response::badRequest(fieldsError);
+            }
+            EdgeFilter filter;
+            std::string filterError;
+            if (!extractEdgeFilter(req, filter, filterError)) {
+                return Response::badRequest(filterError);
+            }
+
+            int id = std::stoi(idStr);
+            auto hood = GraphTraversal::neighborhood(db->getLinkGraph(), id, depth, limit, filter);
+
+            return Response::streamed([hood = std::move(hood), id, depth, fields](JsonWriter& out) {
+                out.beginObject();
+                out.key("center"); out.value(id);
+                out.key("depth"); out.value(depth);
+                out.key("edges");
+                out.beginArray();
+                for (const auto& edge : hood.edges) {
+                    out.beginObject();
+                    out.key("from"); out.value(edge.from);
+                    out.key("to"); out.value(edge.to);
+                    out.key("types"); out.array(EdgeStore::typeNames(edge.types));
+                    out.key("weight"); out.value(static_cast<double>(edge.weight));
+                    out.endObject();
+                }
+                out.endArray();
+                out.key("levels");
+                out.beginArray();
+                for (const auto& level : hood.levels) {
+                    out.array(level);
+                }
+                out.endArray();
+                out.key("nodes");
+                out.beginArray();
+                for (const auto& level : hood.levels) {
+                    for (int nodeId : level) {
+                        if (const Node* node = db->getNode(std::to_string(nodeId))) {
+                            out.raw(node->jsonFragment(fields));
+                        }
+                    }
+                }
+                out.endArray();
+                out.key("status"); out.value("success");
+                out.key("truncated"); out.value(hood.truncated);
+                out.endObject();
+            });
+        },
+        HttpRequest::GET,
+        "/api/nodes/:id/neighborhood"
+    );
+    server->add_endpoint(get_neighborhood);
+
+    // ============================================
+    // GET /api/path - Shortest link path between two nodes
+    // Query params: from, to (required), fields
+    // ============================================
+    endpoint get_path(
+        [](const Request& req) -> Response {
+            if (!req.hasQuery("from") || !req.hasQuery("to")) {
+                return Response::badRequest("Missing from or to parameter");
+            }
+            int from, to;
+            try {
+                from = std::stoi(req.getQuery("from"));
+                to = std::stoi(req.getQuery("to"));
+            } catch (...) {
+                return Response::badRequest("Invalid from or to parameter");
+            }
+            for (int id : {from, to}) {
+                if (!db->exists(std::to_string(id))) {
+                    return Response::notFound("Node not found: " + std::to_string(id));
+                }
+            }
+
+            uint32_t fields;
+            std::string fieldsError;
+            if (!extractFields(req, fields, fieldsError, TRAVERSAL_FIELDS)) {
+                return Response::badRequest(fieldsError);
+            }
+            EdgeFilter filter;
+            std::string filterError;
+            if (!extractEdgeFilter(req, filter, filterError)) {
+                return Response::badRequest(filterError);
+            }
+
+            auto path = GraphTraversal::shortestPath(db->getLinkGraph(), from, to, PATH_MAX_VISITED, filter);
+
+            return Response::streamed([path = std::move(path), from, to, fields](JsonWriter& out) {
+                out.beginObject();
+                out.key("found"); out.value(path.found);
+                out.key("from"); out.value(from);
+                out.key("length"); out.value(path.found ? static_cast<int>(path.nodes.size()) - 1 : -1);
+                out.key("nodes");
+                out.beginArray();
+                for (int nodeId : path.nodes) {
+                    if (const Node* node = db->getNode(std::to_string(nodeId))) {
+                        out.raw(node->jsonFragment(fields));
+                    }
+                }
+                out.endArray();
+                out.key("path"); out.array(path.nodes);
+                out.key("status"); out.value("success");
+                out.key("to"); out.value(to);
+                out.key("truncated"); out.value(path.truncated);
+                out.key("visited"); out.value(static_cast<uint64_t>(path.visited));
+                out.endObject();
+            });
+        },
+        HttpRequest::GET,
+        "/api/path"
+    );
+    server->add_endpoint(get_path);
+
+    // ============================================
+    // GET /api/nodes/:id/cluster - Connected component of a node
+    // ============================================
+    endpoint get_node_cluster(
+        [](const Request& req) -> Response {
+            std::string idStr = req.getParam("id");
+            int id;
+            try {
+                id = std::stoi(idStr);
+            } catch (...) {
+                return Response::badRequest("Invalid node id");
+            }
+
+            int component = db->componentOf(id);
+            if (component < 0) {
+                return Response::notFound("Node not found: " + idStr);
+            }
+
+            json response;
+            response["status"] = "success";
+            response["nodeId"] = id;
+            response["component"] = component;
+            response["size"] = db->componentSize(id);
+            response["components"] = db->componentCount();
+            return Response::ok(response.dump());
+        },
+        HttpRequest::GET,
+        "/api/nodes/:id/cluster"
+    );
+    server->add_endpoint(get_node_cluster);
+
     // ============================================
     // GET /api/clusters - Get all connected components
     // ============================================
@@ -702,7 +1424,7 @@ int main()
                 return Response::error("Tag service not initialized. Set DEEPSEEK_API_KEY environment variable.");
             }
 
-            auto clusters = tagService->getClusters();
+            const auto& clusters = tagService->getClusters();
 
             json response;
             response["status"] = "success";
@@ -725,10 +1447,208 @@ int main()
     );
     server->add_endpoint(get_clusters);
 
+    // ============================================
+    // GET /api/rank - Nodes by PageRank over links
+    // Query params: limit (default: 20), node (personalize the walk on one node)
+    // ============================================
+    endpoint get_rank(
+        [](const Request& req) -> Response {
+            size_t limit = 20;
+            try {
+                if (req.hasQuery("limit")) {
+                    int value = std::stoi(req.getQuery("limit"));
+                    if (value <= 0) throw std::invalid_argument("limit");
+                    limit = static_cast<size_t>(value);
+                }
+            } catch (...) {
+                return Response::badRequest("Invalid limit parameter");
+            }
+
+            json response;
+            response["status"] = "success";
+            std::vector<std::pair<int, double>> ranked;
+            if (req.hasQuery("node")) {
+                std::string idStr = req.getQuery("node");
+                if (!db->exists(idStr)) {
+                    return Response::notFound("Node not found: " + idStr);
+                }
+                EdgeFilter filter;
+                std::string filterError;
+                if (!extractEdgeFilter(req, filter, filterError)) {
+                    return Response::badRequest(filterError);
+                }
+                response["node"] = std::stoi(idStr);
+                ranked = db->personalizedRank(std::stoi(idStr), limit, filter);
+            } else {
+                ranked = db->topRanked(limit);
+                if (db->getRankVersion() == 0) {
+                    // First column still computing: every rank would read 0
+                    json running;
+                    running["status"] = "running";
+                    running["rank"] = db->getRankStatus();
+                    return Response::ok(running.dump());
+                }
+                response["version"] = db->getRankVersion();
+            }
+
+            response["nodes"] = json::array();
+            for (const auto& [id, rank] : ranked) {
+                const Node* node = db->getNode(std::to_string(id));
+                response["nodes"].push_back({
+                    {"id", id},
+                    {"rank", rank},
+                    {"title", node ? node->getTitle() : ""}
+                });
+            }
+            return Response::ok(response.dump());
+        },
+        HttpRequest::GET,
+        "/api/rank"
+    );
+    server->add_endpoint(get_rank);
+
+    // ============================================
+    // GET /api/rank/status - Version of the served ranks and refresh state
+    // ============================================
+    endpoint get_rank_status(
+        [](const Request&) -> Response {
+            json response;
+            response["status"] = "success";
+            response["rank"] = db->getRankStatus();
+            return Response::ok(response.dump());
+        },
+        HttpRequest::GET,
+        "/api/rank/status"
+    );
+    server->add_endpoint(get_rank_status);
+
+    // ============================================
+    // POST /api/rank/compute - Start a PageRank refresh in the background
+    // ============================================
+    endpoint compute_rank(
+        [](const Request&) -> Response {
+            db->scheduleRankRefresh();
+
+            json response;
+            response["status"] = "success";
+            response["rank"] = db->getRankStatus();
+            return Response::ok(response.dump());
+        },
+        HttpRequest::POST,
+        "/api/rank/compute"
+    );
+    server->add_endpoint(compute_rank);
+
+    // ============================================
+    // GET /api/graph/layout - Node positions for the web visualizer
+    // Compact arrays: ids[i] is at (x[i], y[i]); edges holds index pairs into ids
+    // ============================================
+    endpoint get_graph_layout(
+        [](const Request&) -> Response {
+            std::shared_ptr<const LayoutSnapshot> layout = db->getLayout();
+            json status = db->getLayoutStatus();
+            if (!layout) {
+                // First layout still computing (or waiting to retry after a failure, see
+                // layout.error): no positions yet, the client lays out itself
+                json response;
+                response["status"] = "running";
+                response["layout"] = status;
+                return Response::ok(response.dump());
+            }
+
+            return Response::streamed([layout, status](JsonWriter& out) {
+                // Positions rounded to 0.1 (plenty for drawing, a third of the bytes); + 0.0 drops -0
+                auto coordinates = [&out](const std::vector<float>& values) {
+                    out.beginArray();
+                    for (float v : values) out.value(std::round(static_cast<double>(v) * 10.0) / 10.0 + 0.0);
+                    out.endArray();
+                };
+                out.beginObject();
+                out.key("edges");
+                out.beginArray();
+                for (uint32_t v : layout->edges) out.value(static_cast<uint64_t>(v));
+                out.endArray();
+                out.key("ids");
+                out.beginArray();
+                for (uint32_t id : layout->ids) out.value(static_cast<uint64_t>(id));
+                out.endArray();
+                out.key("layout"); out.value(status);
+                out.key("status"); out.value("success");
+                out.key("x"); coordinates(layout->x);
+                out.key("y"); coordinates(layout->y);
+                out.endObject();
+            });
+        },
+        HttpRequest::GET,
+        "/api/graph/layout"
+    );
+    server->add_endpoint(get_graph_layout);
+
+    // ============================================
+    // GET /api/communities - Detected communities, largest first
+    // Query params: limit (default: 20); members via /api/nodes?community=<id>
+    // ============================================
+    endpoint get_communities(
+        [](const Request& req) -> Response {
+            size_t limit = 20;
+            try {
+                if (req.hasQuery("limit")) {
+                    int value = std::stoi(req.getQuery("limit"));
+                    if (value <= 0) throw std::invalid_argument("limit");
+                    limit = static_cast<size_t>(value);
+                }
+            } catch (...) {
+                return Response::badRequest("Invalid limit parameter");
+            }
+
+            json response;
+            response["status"] = "success";
+            response["detection"] = db->getCommunityStatus();
+            response["communities"] = db->listCommunities(limit);
+            return Response::ok(response.dump());
+        },
+        HttpRequest::GET,
+        "/api/communities"
+    );
+    server->add_endpoint(get_communities);
+
+    // ============================================
+    // POST /api/communities - Start Louvain over the links in the background
+    // Query params: resolution (default: 1, higher gives smaller communities),
+    //               min_weight, types
+    // Labels are applied when the run finishes (detection.running in GET /api/communities)
+    // ============================================
+    endpoint detect_communities(
+        [](const Request& req) -> Response {
+            Louvain::Options options;
+            try {
+                if (req.hasQuery("resolution")) {
+                    options.resolution = std::stod(req.getQuery("resolution"));
+                    if (!(options.resolution > 0)) throw std::invalid_argument("resolution");
+                }
+            } catch (...) {
+                return Response::badRequest("Invalid resolution parameter");
+            }
+            std::string filterError;
+            if (!extractEdgeFilter(req, options.filter, filterError)) {
+                return Response::badRequest(filterError);
+            }
+
+            json response;
+            response["status"] = "success";
+            response["detection"] = db->detectCommunities(options);
+            return Response::ok(response.dump());
+        },
+        HttpRequest::POST,
+        "/api/communities"
+    );
+    server->add_endpoint(detect_communities);
+
     std::cout << "TheWhisperDB REST API" << std::endl;
     std::cout << "Endpoints:" << std::endl;
-    std::cout << "  GET    /api/nodes              - List all nodes (supports: ?sort=<field>&order=<asc|desc>&limit=<n>&offset=<n>)" << std::endl;
+    std::cout << "  GET    /api/nodes              - List all nodes (supports: ?sort=<field>&order=<asc|desc>&limit=<n>&offset=<n>&explain=1)" << std::endl;
     std::cout << "  GET    /api/nodes/count        - Count nodes (supports filters)" << std::endl;
+    std::cout << "  GET    /api/facets             - Counts per subject/author/course/tag (supports filters, ?limit=<n>)" << std::endl;
     std::cout << "  GET    /api/nodes/:id          - Get node by ID" << std::endl;
     std::cout << "  POST   /api/nodes              - Create new node" << std::endl;
     std::cout << "  PUT    /api/nodes/:id          - Update node" << std::endl;
@@ -739,17 +1659,38 @@ int main()
     std::cout << "  GET    /api/nodes/:id/similar  - Get similar nodes" << std::endl;
     std::cout << "  POST   /api/nodes/:id/tags     - Generate tags for node (DeepSeek)" << std::endl;
     std::cout << "  POST   /api/cluster            - Run clustering batch job (?threshold=0.75)" << std::endl;
+    std::cout << "  GET    /api/nodes/:id/cluster  - Connected component of a node" << std::endl;
+    std::cout << "  GET    /api/nodes/:id/links    - Direct links with type, weight and timestamp" << std::endl;
+    std::cout << "  GET    /api/nodes/:id/suggested-links - Link suggestions by common neighbors (?score=, ?limit=<n>)" << std::endl;
+    std::cout << "  GET    /api/links/suggested    - Link suggestions for every node (?score=, ?limit=, ?page=, ?offset=)" << std::endl;
+    std::cout << "  GET    /api/links/check        - Last link consistency sweep" << std::endl;
+    std::cout << "  POST   /api/links/repair       - Sweep and repair one-way/dangling links (?wait=1)" << std::endl;
+    std::cout << "  GET    /api/nodes/:id/neighborhood - Nodes within ?depth=<k> hops (?limit=<n>)" << std::endl;
+    std::cout << "  GET    /api/path               - Shortest link path (?from=<id>&to=<id>)" << std::endl;
     std::cout << "  GET    /api/tags               - Get tag bank" << std::endl;
+    std::cout << "  GET    /api/tags/complete      - Autocomplete tags by ?prefix=" << std::endl;
     std::cout << "  GET    /api/tags/:tag/nodes    - Get nodes by tag" << std::endl;
+    std::cout << "  GET    /api/tags/:tag/related  - Co-occurring tags (PMI)" << std::endl;
+    std::cout << "  GET    /api/tags/suggest       - Suggest tags for ?tags=a,b" << std::endl;
     std::cout << "  POST   /api/tags/link-all      - Update all tag-based links" << std::endl;
     std::cout << "  GET    /api/clusters           - Get connected components" << std::endl;
+    std::cout << "  GET    /api/rank               - Top nodes by PageRank (?limit=<n>, ?node=<id> for personalized)" << std::endl;
+    std::cout << "  GET    /api/rank/status        - PageRank version and refresh state" << std::endl;
+    std::cout << "  POST   /api/rank/compute       - Refresh PageRank in the background" << std::endl;
+    std::cout << "  GET    /api/graph/layout       - Node positions and edges for the visualizer (refined in the background)" << std::endl;
+    std::cout << "  GET    /api/communities        - Louvain communities, largest first (?limit=<n>)" << std::endl;
+    std::cout << "  POST   /api/communities        - Detect communities in the background (?resolution=<r>, edge filters)" << std::endl;
     std::cout << "  GET    /health                 - Health check" << std::endl;
     std::cout << std::endl;
-    std::cout << "Supported sort fields: id, title, author, subject, course, date" << std::endl;
-    std::cout << "Supported filters: subject, author, course, title, tag" << std::endl;
+    std::cout << "Supported sort fields: id, title, author, subject, course, date, rank" << std::endl;
+    std::cout << "Supported filters: subject, author, course, title, tag, community" << std::endl;
+    std::cout << "Range filters:     course_min, course_max, date_from, date_to (YYYY-MM-DD[ HH:MM:SS])" << std::endl;
+    std::cout << "Projection:        ?fields=id,title,tags (embedding only when listed, * for all)" << std::endl;
+    std::cout << "Edge filters:      ?min_weight=<w>&types=manual,tag,embedding (links, neighborhood, path, rank?node=, communities, suggested links)" << std::endl;
     std::cout << std::endl;
     std::cout << "Embedding: Set OPENAI_API_KEY environment variable to enable" << std::endl;
     std::cout << "Tagging:   Set DEEPSEEK_API_KEY environment variable to enable" << std::endl;
+    std::cout << "Scanning:  " << db->getScanThreads() << " thread(s), set WHISPERDB_SCAN_THREADS to override" << std::endl;
     std::cout << std::endl;
 
     server->run(8080);
@@ -3,6 +3,8 @@
 #include "http/MultipartParser.hpp"
 #include "http/Request.hpp"
 #include <sstream>
+#include <array>
+#include <cstdio>
 #include <cctype>
 #include <algorithm>
 
@@ -10,6 +12,7 @@ using whisperdb::http::MultipartParser;
 using whisperdb::http::MultipartPart;
 using whisperdb::http::Request;
 using whisperdb::http::Response;
+using whisperdb::http::JsonWriter;
 
 wServer::wServer(): acceptor_(io_context_) {}
 
@@ -280,15 +283,45 @@ void wServer::run(uint16_t port)
             }
         }
 
-        // Send response
-        std::ostringstream http_response;
-        http_response << "HTTP/1.1 " << response.status << " " << status_text(response.status) << "\r\n";
-        http_response << "Content-Length: " << response.body.size() << "\r\n";
-        http_response << "Content-Type: " << response.contentType << "\r\n";
-        http_response << "Connection: close\r\n\r\n";
-        http_response << response.body;
-
-        boost::asio::write(socket, boost::asio::buffer(http_response.str()));
+        // Send response: headers and body go out as separate buffers so the
+        // body is never copied into a combined string
+        std::string headers = "HTTP/1.1 " + std::to_string(response.status) + " " + status_text(response.status) + "\r\n";
+        headers += "Content-Type: " + response.contentType + "\r\n";
+        headers += "Connection: close\r\n";
+
+        if (!response.stream) {
+            headers += "Content-Length: " + std::to_string(response.body.size()) + "\r\n\r\n";
+            std::array<boost::asio::const_buffer, 2> parts = {
+                boost::asio::buffer(headers), boost::asio::buffer(response.body)
+            };
+            boost::asio::write(socket, parts);
+        } else {
+            headers += "Transfer-Encoding: chunked\r\n\r\n";
+            boost::asio::write(socket, boost::asio::buffer(headers));
+
+            // Each writer flush becomes one chunk
+            auto sendChunk = [&socket](const char* data, size_t size) {
+                char sizeLine[24];
+                int n = std::snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", size);
+                std::array<boost::asio::const_buffer, 3> parts = {
+                    boost::asio::buffer(sizeLine, static_cast<size_t>(n)),
+                    boost::asio::buffer(data, size),
+                    boost::asio::buffer("\r\n", 2)
+                };
+                boost::asio::write(socket, parts);
+            };
+
+            try {
+                JsonWriter writer(streamBuffer_, sendChunk);
+                response.stream(writer);
+                writer.flush();
+                boost::asio::write(socket, boost::asio::buffer("0\r\n\r\n", 5));
+            } catch (const std::exception& e) {
+                // Status is already on the wire; dropping the connection without
+                // the terminating chunk tells the client the body is incomplete
+                std::cerr << "Streaming response failed: " << e.what() << std::endl;
+            }
+        }
         socket.close();
     }
 }
@@ -0,0 +1,117 @@
+#include "tagging/MinHash.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    uint64_t mix64(uint64_t x) {
+        // splitmix64 finalizer
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    const size_t SIGNATURE_MORSEL = 256;
+}
+
+MinHashLSH::MinHashLSH(size_t bands, size_t rows, uint64_t seed)
+    : bands_(std::max<size_t>(bands, 1)), rows_(std::max<size_t>(rows, 1))
+{
+    seeds_.resize(bands_ * rows_);
+    for (size_t i = 0; i < seeds_.size(); ++i) {
+        seeds_[i] = mix64(seed + i);
+    }
+}
+
+MinHashLSH MinHashLSH::forThreshold(double threshold, size_t numHashes, double targetRecall)
+{
+    threshold = std::clamp(threshold, 0.01, 1.0);
+    numHashes = std::max<size_t>(numHashes, 1);
+
+    // More rows per band = fewer false candidates; stop at the last one that
+    // still keeps the collision probability at the threshold high enough
+    size_t bestRows = 1;
+    for (size_t rows = 1; rows <= numHashes; ++rows) {
+        size_t bands = numHashes / rows;
+        double p = 1.0 - std::pow(1.0 - std::pow(threshold, static_cast<double>(rows)), static_cast<double>(bands));
+        if (p >= targetRecall) {
+            bestRows = rows;
+        }
+    }
+    return MinHashLSH(numHashes / bestRows, bestRows);
+}
+
+double MinHashLSH::candidateProbability(double similarity) const
+{
+    return 1.0 - std::pow(1.0 - std::pow(similarity, static_cast<double>(rows_)), static_cast<double>(bands_));
+}
+
+void MinHashLSH::signature(const std::vector<TagId>& tags, uint32_t* out) const
+{
+    for (size_t i = 0; i < seeds_.size(); ++i) {
+        uint32_t best = std::numeric_limits<uint32_t>::max();
+        for (TagId tag : tags) {
+            best = std::min(best, static_cast<uint32_t>(mix64(seeds_[i] ^ tag)));
+        }
+        out[i] = best;
+    }
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> MinHashLSH::candidatePairs(const std::vector<const std::vector<TagId>*>& sets) const
+{
+    size_t n = sets.size();
+
+    // One 64-bit key per (set, band); only the keys are kept, not the signatures
+    std::vector<uint64_t> bandKeys(n * bands_, 0);
+    ThreadPool::current().parallelFor(n, SIGNATURE_MORSEL, [&](size_t begin, size_t end, size_t) {
+        std::vector<uint32_t> sig(signatureSize());
+        for (size_t i = begin; i < end; ++i) {
+            if (sets[i]->empty()) continue;
+            signature(*sets[i], sig.data());
+            for (size_t b = 0; b < bands_; ++b) {
+                uint64_t key = b;
+                for (size_t r = 0; r < rows_; ++r) {
+                    key = mix64(key ^ sig[b * rows_ + r]);
+                }
+                bandKeys[i * bands_ + b] = key;
+            }
+        }
+    });
+
+    // Group equal keys per band; every pair inside a bucket is a candidate
+    std::vector<uint64_t> pairs;
+    std::vector<std::pair<uint64_t, uint32_t>> bucket;
+    bucket.reserve(n);
+    for (size_t b = 0; b < bands_; ++b) {
+        bucket.clear();
+        for (size_t i = 0; i < n; ++i) {
+            if (!sets[i]->empty()) {
+                bucket.emplace_back(bandKeys[i * bands_ + b], static_cast<uint32_t>(i));
+            }
+        }
+        std::sort(bucket.begin(), bucket.end());
+
+        for (size_t start = 0; start < bucket.size();) {
+            size_t end = start + 1;
+            while (end < bucket.size() && bucket[end].first == bucket[start].first) ++end;
+            for (size_t x = start; x < end; ++x) {
+                for (size_t y = x + 1; y < end; ++y) {
+                    pairs.push_back((static_cast<uint64_t>(bucket[x].second) << 32) | bucket[y].second);
+                }
+            }
+            start = end;
+        }
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    std::vector<std::pair<uint32_t, uint32_t>> result;
+    result.reserve(pairs.size());
+    for (uint64_t p : pairs) {
+        result.emplace_back(static_cast<uint32_t>(p >> 32), static_cast<uint32_t>(p));
+    }
+    return result;
+}
@@ -165,6 +165,10 @@ std::optional<std::vector<std::string>> TagClient::generateTags(
     }
 
     std::string systemPrompt = buildSystemPrompt(existingTagBank);
+    lastPrompt_ = TagPromptStats{};
+    lastPrompt_.bankTags = existingTagBank.size();
+    lastPrompt_.systemBytes = systemPrompt.size();
+    lastPrompt_.userBytes = content.size();
 
     nlohmann::json requestBody = {
         {"model", model_},
@@ -187,6 +191,10 @@ std::optional<std::vector<std::string>> TagClient::generateTags(
 
         nlohmann::json jsonResponse = nlohmann::json::parse(response);
 
+        if (jsonResponse.contains("usage") && jsonResponse["usage"].contains("prompt_tokens")) {
+            lastPrompt_.promptTokens = jsonResponse["usage"]["prompt_tokens"].get<int>();
+        }
+
         if (jsonResponse.contains("choices") && jsonResponse["choices"].is_array() &&
             !jsonResponse["choices"].empty()) {
             auto& choice = jsonResponse["choices"][0];
@@ -1,10 +1,101 @@
 #include "tagging/TagService.hpp"
 #include "embedding/TextExtractor.hpp"
+#include "tagging/MinHash.hpp"
+#include "config.hpp"
 #include <iostream>
 #include <filesystem>
 #include <algorithm>
-#include <unordered_set>
-#include <queue>
+#include <chrono>
+#include <cmath>
+#include <cctype>
+
+namespace {
+    // ASCII and Cyrillic lowercase over UTF-8 bytes
+    std::string foldCase(const std::string& text) {
+        std::string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            unsigned char next = i + 1 < text.size() ? static_cast<unsigned char>(text[i + 1]) : 0;
+            if (c < 0x80) {
+                out += static_cast<char>(std::tolower(c));
+            } else if (c == 0xD0 && next >= 0x90 && next <= 0x9F) { // А-П
+                out += static_cast<char>(0xD0);
+                out += static_cast<char>(next + 0x20);
+                ++i;
+            } else if (c == 0xD0 && next >= 0xA0 && next <= 0xAF) { // Р-Я
+                out += static_cast<char>(0xD1);
+                out += static_cast<char>(next - 0x20);
+                ++i;
+            } else if (c == 0xD0 && next == 0x81) { // Ё
+                out += static_cast<char>(0xD1);
+                out += static_cast<char>(0x91);
+                ++i;
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+        return out;
+    }
+
+    // Words of lowercased text; any non-ASCII byte counts as a letter
+    std::vector<std::string> tokenize(const std::string& text) {
+        std::vector<std::string> tokens;
+        std::string folded = foldCase(text);
+        std::string current;
+        for (char ch : folded) {
+            unsigned char c = static_cast<unsigned char>(ch);
+            if (c >= 0x80 || std::isalnum(c)) {
+                current += ch;
+            } else if (!current.empty()) {
+                tokens.push_back(std::move(current));
+                current.clear();
+            }
+        }
+        if (!current.empty()) {
+            tokens.push_back(std::move(current));
+        }
+        return tokens;
+    }
+
+    // Crude stemming: equal, or sharing at least 3/4 of the longer word
+    // ("algorithm"/"algorithms", "сортировка"/"сортировки")
+    bool sameStem(const std::string& a, const std::string& b) {
+        size_t common = 0;
+        size_t n = std::min(a.size(), b.size());
+        while (common < n && a[common] == b[common]) ++common;
+        return a == b || (common >= 4 && common * 4 >= std::max(a.size(), b.size()) * 3);
+    }
+
+    // Share of the tag's words found in `words` (sorted, unique)
+    double lexicalOverlap(const std::string& tag, const std::vector<std::string>& words) {
+        std::vector<std::string> parts = tokenize(tag);
+        if (parts.empty()) {
+            return 0.0;
+        }
+
+        size_t matched = 0;
+        for (const auto& part : parts) {
+            if (std::binary_search(words.begin(), words.end(), part)) {
+                matched++;
+                continue;
+            }
+            if (part.size() < 4) continue;
+            // Stem candidates share the first 4 bytes
+            std::string head = part.substr(0, 4);
+            for (auto it = std::lower_bound(words.begin(), words.end(), head);
+                 it != words.end() && it->compare(0, head.size(), head) == 0; ++it) {
+                if (sameStem(part, *it)) {
+                    matched++;
+                    break;
+                }
+            }
+        }
+        return static_cast<double>(matched) / static_cast<double>(parts.size());
+    }
+
+    const size_t PROMPT_CONTEXT_TAGS = 8; // Lexical hits used to pull in co-occurring tags
+}
 
 TagService::TagService(GraphDB& db, const std::string& apiKey)
     : db_(db), client_(apiKey) {}
@@ -58,11 +149,13 @@ TagGenerationResult TagService::generateTagsForNode(int nodeId, const std::strin
         return result;
     }
 
-    // Get current tag bank
-    auto tagBank = db_.getTagBank();
+    // Only the part of the tag bank relevant to this document goes into the prompt
+    result.bankSize = db_.getTagBank().size();
+    std::vector<std::string> promptTags = selectPromptTags(node, content, PROMPT_TAG_LIMIT);
 
     // Generate tags using DeepSeek
-    auto tagsOpt = client_.generateTags(content, tagBank);
+    auto tagsOpt = client_.generateTags(content, promptTags);
+    result.prompt = client_.lastPromptStats();
     if (!tagsOpt) {
         result.error = "Failed to generate tags from AI";
         return result;
@@ -72,7 +165,7 @@ TagGenerationResult TagService::generateTagsForNode(int nodeId, const std::strin
 
     // Find new tags (not in tag bank)
     for (const auto& tag : result.generatedTags) {
-        if (std::find(tagBank.begin(), tagBank.end(), tag) == tagBank.end()) {
+        if (!db_.isInTagBank(tag)) {
             result.newTagsAdded.push_back(tag);
         }
     }
@@ -94,7 +187,77 @@ TagGenerationResult TagService::generateTagsForNode(int nodeId, const std::strin
     return result;
 }
 
-std::vector<std::string> TagService::getTagBank() const {
+std::vector<std::string> TagService::selectPromptTags(const Node& node, const std::string& content, size_t limit) const {
+    const auto& bank = db_.getTagBank();
+    if (bank.size() <= limit) {
+        return bank;
+    }
+
+    const TagDictionary& dictionary = db_.getTagDictionary();
+    std::vector<std::string> words = tokenize(content);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    std::unordered_map<std::string, size_t> bankIndex;
+    bankIndex.reserve(bank.size());
+    uint32_t maxUsage = 0;
+    for (size_t i = 0; i < bank.size(); ++i) {
+        bankIndex.emplace(bank[i], i);
+        maxUsage = std::max(maxUsage, dictionary.usage(dictionary.find(bank[i])));
+    }
+
+    // Word overlap dominates; usage only orders tags with no other evidence
+    std::vector<double> score(bank.size(), 0.0);
+    std::vector<std::pair<double, size_t>> lexical;
+    for (size_t i = 0; i < bank.size(); ++i) {
+        double overlap = lexicalOverlap(bank[i], words);
+        uint32_t usage = dictionary.usage(dictionary.find(bank[i]));
+        score[i] = 2.0 * overlap + 0.1 * std::log1p(usage) / std::log1p(std::max<uint32_t>(maxUsage, 1));
+        if (overlap > 0) {
+            lexical.emplace_back(overlap, i);
+        }
+    }
+
+    // Tags the node already has, plus the best lexical hits, pull in the tags
+    // they usually appear with
+    std::vector<std::string> context;
+    for (const auto& tag : node.getTags()) {
+        auto it = bankIndex.find(tag);
+        if (it != bankIndex.end()) {
+            score[it->second] += 2.0;
+            context.push_back(tag);
+        }
+    }
+    std::sort(lexical.begin(), lexical.end(), std::greater<>());
+    for (size_t i = 0; i < lexical.size() && i < PROMPT_CONTEXT_TAGS; ++i) {
+        context.push_back(bank[lexical[i].second]);
+    }
+
+    auto related = db_.suggestTags(context, limit);
+    double maxPmi = 0;
+    for (const auto& r : related) maxPmi = std::max(maxPmi, r.pmi);
+    for (const auto& r : related) {
+        auto it = bankIndex.find(dictionary.name(r.tag));
+        if (it != bankIndex.end() && maxPmi > 0) {
+            score[it->second] += r.pmi / maxPmi;
+        }
+    }
+
+    std::vector<size_t> order(bank.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::partial_sort(order.begin(), order.begin() + limit, order.end(), [&score](size_t a, size_t b) {
+        return score[a] != score[b] ? score[a] > score[b] : a < b;
+    });
+
+    std::vector<std::string> selected;
+    selected.reserve(limit);
+    for (size_t i = 0; i < limit; ++i) {
+        selected.push_back(bank[order[i]]);
+    }
+    return selected;
+}
+
+const std::vector<std::string>& TagService::getTagBank() const {
     return db_.getTagBank();
 }
 
@@ -107,141 +270,132 @@ std::vector<int> TagService::findNodesByTag(const std::string& tag) const {
 }
 
 void TagService::addBidirectionalLink(int nodeId1, int nodeId2) {
-    std::string id1Str = std::to_string(nodeId1);
-    std::string id2Str = std::to_string(nodeId2);
+    db_.addLinks({{nodeId1, nodeId2}});
+}
 
-    if (!db_.exists(id1Str) || !db_.exists(id2Str)) {
-        return;
+int TagService::updateLinksForNode(int nodeId, float jaccardThreshold) {
+    std::vector<WeightedLink> links;
+    for (const auto& [otherId, score] : db_.scoreTagSimilarity(nodeId, jaccardThreshold)) {
+        links.push_back({nodeId, otherId, score});
     }
+    return db_.addLinks(links, EDGE_TAG);
+}
 
-    // Update node1's links
-    Node node1 = db_.find(id1Str);
-    auto links1 = node1.getLinkedNodes();
-    if (std::find(links1.begin(), links1.end(), nodeId2) == links1.end()) {
-        links1.push_back(nodeId2);
-        node1.setLinkedNodes(links1);
-        db_.updateNode(id1Str, node1.to_json());
+LinkAllResult TagService::updateAllTagBasedLinks(float jaccardThreshold, bool measureRecall) {
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point from) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - from).count();
+    };
+
+    LinkAllResult result;
+    auto start = Clock::now();
+
+    // Tag sets of all nodes, by reference into the store
+    std::vector<const Node*> nodes = db_.queryNodes({});
+    std::vector<const std::vector<TagId>*> sets;
+    sets.reserve(nodes.size());
+    for (const Node* node : nodes) {
+        sets.push_back(&node->getTagIds());
+        if (!node->getTagIds().empty()) result.nodesWithTags++;
     }
 
-    // Update node2's links
-    Node node2 = db_.find(id2Str);
-    auto links2 = node2.getLinkedNodes();
-    if (std::find(links2.begin(), links2.end(), nodeId1) == links2.end()) {
-        links2.push_back(nodeId1);
-        node2.setLinkedNodes(links2);
-        db_.updateNode(id2Str, node2.to_json());
+    // Candidates from LSH, kept only if the exact score passes
+    MinHashLSH lsh = MinHashLSH::forThreshold(jaccardThreshold);
+    result.bands = lsh.bands();
+    result.rows = lsh.rows();
+
+    std::vector<WeightedLink> edges;
+    auto candidates = lsh.candidatePairs(sets);
+    result.candidatePairs = candidates.size();
+    for (const auto& [i, j] : candidates) {
+        int a = nodes[i]->getId();
+        int b = nodes[j]->getId();
+        float score = db_.tagSimilarity(a, b);
+        if (score > 0.0f && score >= jaccardThreshold) {
+            edges.push_back({a, b, score});
+        }
     }
-}
-
-int TagService::updateLinksForNode(int nodeId, float jaccardThreshold) {
-    auto similarNodes = db_.findNodesWithJaccardSimilarity(nodeId, jaccardThreshold);
-    int linksCreated = 0;
-
-    for (int otherId : similarNodes) {
-        // Check if link already exists
-        std::string nodeIdStr = std::to_string(nodeId);
-        Node node = db_.find(nodeIdStr);
-        auto links = node.getLinkedNodes();
-
-        if (std::find(links.begin(), links.end(), otherId) == links.end()) {
-            addBidirectionalLink(nodeId, otherId);
-            linksCreated++;
+    result.similarPairs = edges.size();
+
+    // Exact all-pairs count for recall, before any links change the store
+    if (measureRecall) {
+        auto exactStart = Clock::now();
+        for (const Node* node : nodes) {
+            for (const auto& [otherId, score] : db_.scoreTagSimilarity(node->getId(), jaccardThreshold)) {
+                if (otherId > node->getId()) result.exactPairs++;
+            }
         }
+        result.exactMs = elapsedMs(exactStart);
+        result.recall = result.exactPairs ? static_cast<double>(result.similarPairs) / result.exactPairs : 1.0;
+        result.recallMeasured = true;
     }
 
-    return linksCreated;
+    auto linkStart = Clock::now();
+    result.linksCreated = db_.addLinks(edges, EDGE_TAG);
+    result.elapsedMs = elapsedMs(start) - result.exactMs;
+    std::cout << "Tag link-all: " << result.candidatePairs << " candidates, " << result.similarPairs
+              << " pairs >= " << jaccardThreshold << ", " << result.linksCreated << " new links in "
+              << result.elapsedMs << " ms (write " << elapsedMs(linkStart) << " ms)" << std::endl;
+    return result;
 }
 
-int TagService::updateAllTagBasedLinks(float jaccardThreshold) {
-    int totalLinks = 0;
-    auto allNodes = db_.getAllNodes();
-
-    for (const auto& nodeJson : allNodes) {
-        Node node(nodeJson);
-        if (!node.getTags().empty()) {
-            totalLinks += updateLinksForNode(node.getId(), jaccardThreshold);
-        }
+const std::vector<ClusterInfo>& TagService::getClusters() const {
+    std::pair<uint64_t, uint64_t> current{db_.getLinkGeneration(), db_.getTagGeneration()};
+    if (clustersGeneration_ == current) {
+        return clusters_;
     }
 
-    return totalLinks;
-}
-
-std::vector<ClusterInfo> TagService::getClusters() const {
     std::vector<ClusterInfo> clusters;
-    auto allNodes = db_.getAllNodes();
+    const TagDictionary& dictionary = db_.getTagDictionary();
 
-    // Build adjacency map and collect all node IDs
-    std::unordered_map<int, std::vector<int>> adjacency;
-    std::unordered_set<int> allNodeIds;
-
-    for (const auto& nodeJson : allNodes) {
-        Node node(nodeJson);
-        int nodeId = node.getId();
-        allNodeIds.insert(nodeId);
-        adjacency[nodeId] = node.getLinkedNodes();
+    // Group nodes by component representative; ids stay ascending inside a group
+    std::vector<std::pair<int, const Node*>> members;
+    for (const Node* node : db_.queryNodes({})) {
+        members.emplace_back(db_.componentOf(node->getId()), node);
     }
+    std::stable_sort(members.begin(), members.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
 
-    // Find connected components using BFS
-    std::unordered_set<int> visited;
-    int clusterId = 1;
-
-    for (int startId : allNodeIds) {
-        if (visited.count(startId)) continue;
-
+    std::unordered_map<TagId, int> tagCounts;
+    for (size_t start = 0; start < members.size();) {
+        size_t end = start;
         ClusterInfo cluster;
-        cluster.id = clusterId++;
-
-        // BFS
-        std::queue<int> q;
-        q.push(startId);
-        visited.insert(startId);
-
-        std::unordered_map<std::string, int> tagCounts;
-
-        while (!q.empty()) {
-            int current = q.front();
-            q.pop();
-            cluster.nodeIds.push_back(current);
-
-            // Get tags for this node
-            std::string currentIdStr = std::to_string(current);
-            if (db_.exists(currentIdStr)) {
-                Node currentNode = db_.find(currentIdStr);
-                for (const auto& tag : currentNode.getTags()) {
-                    tagCounts[tag]++;
-                }
-            }
-
-            // Visit neighbors
-            for (int neighbor : adjacency[current]) {
-                if (!visited.count(neighbor)) {
-                    visited.insert(neighbor);
-                    q.push(neighbor);
-                }
+        cluster.id = static_cast<int>(clusters.size() + 1);
+        tagCounts.clear();
+
+        for (; end < members.size() && members[end].first == members[start].first; ++end) {
+            const Node* node = members[end].second;
+            cluster.nodeIds.push_back(node->getId());
+            for (TagId tag : node->getTagIds()) {
+                tagCounts[tag]++;
             }
         }
 
         // Find shared tags (appearing in more than one node, or all tags if single node)
         if (cluster.nodeIds.size() == 1) {
             // Single node - show its tags
-            std::string idStr = std::to_string(cluster.nodeIds[0]);
-            if (db_.exists(idStr)) {
-                cluster.sharedTags = db_.find(idStr).getTags();
-            }
+            cluster.sharedTags = members[start].second->getTags();
         } else {
-            // Multiple nodes - show tags that appear in at least 2 nodes
+            // Multiple nodes - show tags that appear in at least 2 nodes, most common first
+            std::vector<std::pair<int, TagId>> shared;
             for (const auto& [tag, count] : tagCounts) {
                 if (count >= 2) {
-                    cluster.sharedTags.push_back(tag);
+                    shared.emplace_back(-count, tag);
                 }
             }
+            std::sort(shared.begin(), shared.end());
+            for (const auto& entry : shared) {
+                cluster.sharedTags.push_back(dictionary.name(entry.second));
+            }
         }
 
-        clusters.push_back(cluster);
+        clusters.push_back(std::move(cluster));
+        start = end;
     }
 
     // Sort clusters by size (largest first)
-    std::sort(clusters.begin(), clusters.end(),
+    std::stable_sort(clusters.begin(), clusters.end(),
         [](const ClusterInfo& a, const ClusterInfo& b) {
             return a.nodeIds.size() > b.nodeIds.size();
         });
@@ -251,5 +405,7 @@ std::vector<ClusterInfo> TagService::getClusters() const {
         clusters[i].id = static_cast<int>(i + 1);
     }
 
-    return clusters;
+    clusters_ = std::move(clusters);
+    clustersGeneration_ = current;
+    return clusters_;
 }
@@ -128,7 +128,8 @@ async function loadNodes() {
             });
         });
 
-        updateGraph();
+        const presetLayout = await applyServerLayout();
+        updateGraph(presetLayout);
         updateStats();
         notify('Граф загружен', 'success');
     } catch (error) {
@@ -139,8 +140,48 @@ async function loadNodes() {
     }
 }
 
+// Позиции из серверной раскладки (/api/graph/layout), вписанные в область графа.
+// true, если размещены все узлы: тогда браузеру остаётся только отрисовка
+async function applyServerLayout() {
+    try {
+        const response = await fetch(`${API_BASE}/api/graph/layout`);
+        if (!response.ok) return false;
+        const layout = await response.json();
+        if (!layout.ids || layout.ids.length === 0) return false;
+
+        let minX = Infinity, maxX = -Infinity, minY = Infinity, maxY = -Infinity;
+        for (let i = 0; i < layout.ids.length; i++) {
+            minX = Math.min(minX, layout.x[i]);
+            maxX = Math.max(maxX, layout.x[i]);
+            minY = Math.min(minY, layout.y[i]);
+            maxY = Math.max(maxY, layout.y[i]);
+        }
+        const container = document.querySelector('.graph-container');
+        const margin = 60;
+        const scale = Math.min(
+            (container.clientWidth - 2 * margin) / Math.max(maxX - minX, 1),
+            (container.clientHeight - 2 * margin) / Math.max(maxY - minY, 1)
+        );
+
+        const indexById = new Map(layout.ids.map((id, i) => [id, i]));
+        let placed = 0;
+        graphData.nodes.forEach(node => {
+            const i = indexById.get(node.id);
+            if (i === undefined) return;
+            node.x = margin + (layout.x[i] - minX) * scale;
+            node.y = margin + (layout.y[i] - minY) * scale;
+            placed++;
+        });
+        return placed === graphData.nodes.length;
+    } catch (error) {
+        console.warn('Server layout unavailable, using browser layout:', error);
+        return false;
+    }
+}
+
 // Обновление визуализации графа
-function updateGraph() {
+// presetLayout: позиции уже заданы сервером, симуляция не запускается
+function updateGraph(presetLayout = false) {
     const container = document.querySelector('.graph-container');
     const width = container.clientWidth;
     const height = container.clientHeight;
@@ -148,6 +189,7 @@ function updateGraph() {
     const g = svg.select('.graph-group');
 
     // Симуляция силы
+    if (simulation) simulation.stop();
     simulation = d3.forceSimulation(graphData.nodes)
         .force('link', d3.forceLink(graphData.links).id(d => d.id).distance(100))
         .force('charge', d3.forceManyBody().strength(-300))
@@ -219,7 +261,7 @@ function updateGraph() {
     });
 
     // Обновление позиций при симуляции
-    simulation.on('tick', () => {
+    const ticked = () => {
         links
             .attr('x1', d => d.source.x)
             .attr('y1', d => d.source.y)
@@ -227,7 +269,14 @@ function updateGraph() {
             .attr('y2', d => d.target.y);
 
         nodes.attr('transform', d => `translate(${d.x},${d.y})`);
-    });
+    };
+    simulation.on('tick', ticked);
+
+    // Готовая раскладка: отрисовать один раз; силы оживают только при перетаскивании
+    if (presetLayout) {
+        simulation.alpha(0).stop();
+        ticked();
+    }
 }
 
 // Подсветка связей узла